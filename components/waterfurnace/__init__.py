@@ -14,17 +14,60 @@ AUTO_LOAD = []
 MULTI_CONF = False
 
 CONF_WATERFURNACE_ID = "waterfurnace_id"
+CONF_FORCE_PUBLISH_INTERVAL = "force_publish_interval"
+CONF_ADAPTIVE_POLLING = "adaptive_polling"
+CONF_IDLE_INTERVAL = "idle_interval"
+CONF_RUNNING_INTERVAL = "running_interval"
+CONF_TRANSITION_INTERVAL = "transition_interval"
+CONF_TRANSITION_DURATION = "transition_duration"
+CONF_FRAMING = "framing"
+CONF_FRAME_IDLE_TIMEOUT = "frame_idle_timeout"
+CONF_BUS_TASK = "bus_task"
 
 waterfurnace_ns = cg.esphome_ns.namespace("waterfurnace")
 WaterFurnace = waterfurnace_ns.class_(
     "WaterFurnace", cg.PollingComponent, uart.UARTDevice
 )
+FramingMode = waterfurnace_ns.enum("FramingMode", is_class=True)
+FRAMING_MODES = {
+    "length": FramingMode.LENGTH,
+    "idle": FramingMode.IDLE,
+    "auto": FramingMode.AUTO,
+}
+
+ADAPTIVE_POLLING_SCHEMA = cv.Schema(
+    {
+        cv.Optional(
+            CONF_IDLE_INTERVAL, default="60s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_RUNNING_INTERVAL, default="10s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_TRANSITION_INTERVAL, default="2s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_TRANSITION_DURATION, default="3min"
+        ): cv.positive_time_period_milliseconds,
+    }
+)
 
 CONFIG_SCHEMA = (
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(WaterFurnace),
             cv.Optional(CONF_FLOW_CONTROL_PIN): pins.gpio_output_pin_schema,
+            cv.Optional(
+                CONF_FORCE_PUBLISH_INTERVAL, default="5min"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ADAPTIVE_POLLING): ADAPTIVE_POLLING_SCHEMA,
+            cv.Optional(CONF_FRAMING, default="length"): cv.enum(
+                FRAMING_MODES, lower=True
+            ),
+            cv.Optional(
+                CONF_FRAME_IDLE_TIMEOUT, default="20ms"
+            ): cv.positive_time_period_microseconds,
+            cv.Optional(CONF_BUS_TASK): cv.All(cv.boolean, cv.only_on_esp32),
         }
     )
     .extend(cv.polling_component_schema("10s"))
@@ -40,3 +83,24 @@ async def to_code(config):
     if CONF_FLOW_CONTROL_PIN in config:
         pin = await cg.gpio_pin_expression(config[CONF_FLOW_CONTROL_PIN])
         cg.add(var.set_flow_control_pin(pin))
+
+    cg.add(var.set_force_publish_interval(config[CONF_FORCE_PUBLISH_INTERVAL]))
+    cg.add(
+        var.set_framing(
+            FRAMING_MODES[config[CONF_FRAMING]], config[CONF_FRAME_IDLE_TIMEOUT]
+        )
+    )
+
+    if config.get(CONF_BUS_TASK, False):
+        cg.add(var.set_bus_task(True))
+
+    if CONF_ADAPTIVE_POLLING in config:
+        conf = config[CONF_ADAPTIVE_POLLING]
+        cg.add(
+            var.set_adaptive_polling(
+                conf[CONF_IDLE_INTERVAL],
+                conf[CONF_RUNNING_INTERVAL],
+                conf[CONF_TRANSITION_INTERVAL],
+                conf[CONF_TRANSITION_DURATION],
+            )
+        )
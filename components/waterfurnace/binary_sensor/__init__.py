@@ -1,7 +1,7 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import binary_sensor
-from esphome.const import CONF_ID
+from esphome.const import CONF_ID, CONF_UPDATE_INTERVAL
 from .. import waterfurnace_ns, WaterFurnace, CONF_WATERFURNACE_ID
 
 DEPENDENCIES = ["waterfurnace"]
@@ -38,7 +38,12 @@ CONFIG_SCHEMA = cv.Schema(
         cv.GenerateID(CONF_WATERFURNACE_ID): cv.use_id(WaterFurnace),
         **{
             cv.Optional(key): binary_sensor.binary_sensor_schema().extend(
-                {cv.GenerateID(): cv.declare_id(WaterFurnaceBinarySensor)}
+                {
+                    cv.GenerateID(): cv.declare_id(WaterFurnaceBinarySensor),
+                    cv.Optional(
+                        CONF_UPDATE_INTERVAL
+                    ): cv.positive_time_period_milliseconds,
+                }
             )
             for key in BINARY_SENSOR_TYPES
         },
@@ -59,3 +64,5 @@ async def to_code(config):
         cg.add(var.set_parent(parent))
         cg.add(var.set_register_address(register))
         cg.add(var.set_bitmask(bitmask))
+        if CONF_UPDATE_INTERVAL in conf:
+            cg.add(var.set_update_interval(conf[CONF_UPDATE_INTERVAL]))
@@ -0,0 +1,157 @@
+#include "bus_worker.h"
+
+namespace esphome {
+namespace waterfurnace {
+
+#ifdef USE_ESP32
+bool BusWorker::start(uint8_t core) {
+#else
+bool BusWorker::start(uint8_t /*core*/) {
+#endif
+  if (this->running())
+    return true;
+  this->running_.store(true, std::memory_order_release);
+#ifdef USE_ESP32
+  auto task = [](void *arg) {
+    auto *worker = static_cast<BusWorker *>(arg);
+    worker->run_();
+    // The worker may be freed as soon as stop() is notified: nothing of it is touched after
+    TaskHandle_t stopping = worker->stopping_;
+    worker->task_ = nullptr;
+    xTaskNotifyGive(stopping);
+    vTaskDelete(nullptr);
+  };
+  if (xTaskCreatePinnedToCore(task, "waterfurnace_bus", 4096, this, 5, &this->task_, core) == pdPASS)
+    return true;
+#elif defined(WATERFURNACE_BUS_THREAD)
+  this->thread_ = std::thread([this]() { this->run_(); });
+  return true;
+#endif
+  this->running_.store(false, std::memory_order_release);
+  return false;
+}
+
+void BusWorker::stop() {
+#ifdef USE_ESP32
+  if (this->task_ != nullptr) {
+    this->stopping_ = xTaskGetCurrentTaskHandle();
+    this->running_.store(false, std::memory_order_release);
+    // The task may be in the middle of a step(); wait for it to leave run_()
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return;
+  }
+#endif
+  this->running_.store(false, std::memory_order_release);
+#ifdef WATERFURNACE_BUS_THREAD
+  if (this->thread_.joinable())
+    this->thread_.join();
+#endif
+}
+
+void BusWorker::run_() {
+  while (this->running()) {
+    if (!this->step())
+      this->port_->yield();
+  }
+}
+
+bool BusWorker::step() {
+  uint32_t now = this->port_->micros();
+  switch (this->state_) {
+    case State::IDLE: {
+      if (!this->requests_.pop(this->request_))
+        return false;
+      // Whatever is still buffered answers an earlier request
+      uint8_t scratch[32];
+      while (this->port_->read(scratch, sizeof(scratch)) > 0) {
+      }
+      this->rx_.reset();
+      this->port_->set_transmit(true);
+      this->port_->write(this->request_.frame, this->request_.len);
+      // Plus a character of margin for the UART to start
+      this->tx_done_us_ = now + (this->request_.len + 1u) * char_time_us(this->timing_);
+      this->state_ = State::TRANSMITTING;
+      return true;
+    }
+
+    case State::TRANSMITTING: {
+      if (static_cast<int32_t>(now - this->tx_done_us_) < 0)
+        return false;
+      this->port_->set_transmit(false);
+      this->rx_.reset();
+      this->transaction_.id = this->request_.id;
+      this->transaction_.func_code = this->request_.frame[1];
+      this->transaction_.response_len = this->request_.response_len;
+      this->transaction_.sent_us = this->tx_done_us_;
+      this->last_byte_us_ = now;
+      this->state_ = State::WAITING_RESPONSE;
+      return true;
+    }
+
+    case State::WAITING_RESPONSE: {
+      bool progress = false;
+      while (true) {
+        size_t contiguous;
+        uint8_t *dst = this->rx_.write_ptr(contiguous);
+        size_t n = contiguous > 0 ? this->port_->read(dst, contiguous) : 0;
+        if (n == 0)
+          break;
+        this->rx_.commit(n);
+        // After the read: this thread may have been preempted since now was taken
+        this->last_byte_us_ = this->port_->micros();
+        progress = true;
+      }
+      if (progress)
+        now = this->last_byte_us_;
+
+      size_t len = this->rx_.poll(this->result_.frame);
+      if (len == 0 && this->rx_.buffered() > 0 && now - this->last_byte_us_ >= this->idle_us_) {
+        uint32_t malformed = this->rx_.malformed_frames();
+        len = this->rx_.close(this->result_.frame);
+        if (this->rx_.malformed_frames() != malformed) {
+          this->finish_(BusStatus::MALFORMED, 0, now);
+          return true;
+        }
+      }
+      if (len > 0) {
+        if (answers_transaction(this->transaction_, this->result_.frame, len, this->last_byte_us_,
+                                char_time_us(this->timing_))) {
+          this->finish_(BusStatus::RESPONSE, len, this->last_byte_us_);
+        } else {
+          // A late answer to an earlier request: keep waiting for ours
+          this->stale_responses_++;
+        }
+        return true;
+      }
+      if (now - this->transaction_.sent_us > this->request_.timeout_us) {
+        this->finish_(BusStatus::TIMEOUT, 0, now);
+        return true;
+      }
+      return progress;
+    }
+
+    case State::DELIVERING: {
+      if (!this->results_.push(this->result_))
+        return false;
+      this->state_ = State::IDLE;
+      return true;
+    }
+  }
+  return false;
+}
+
+void BusWorker::finish_(BusStatus status, size_t len, uint32_t received_us) {
+  this->result_.id = this->request_.id;
+  this->result_.status = status;
+  this->result_.len = static_cast<uint16_t>(len);
+  this->result_.sent_us = this->transaction_.sent_us;
+  this->result_.received_us = received_us;
+  this->result_.skipped_bytes = this->rx_.skipped_bytes();
+  this->result_.length_frames = this->rx_.length_frames();
+  this->result_.idle_frames = this->rx_.idle_frames();
+  this->result_.stale_responses = this->stale_responses_;
+  this->state_ = this->results_.push(this->result_) ? State::IDLE : State::DELIVERING;
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "frame_assembler.h"
+#include "poll_planner.h"
+#include "protocol.h"
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif !defined(USE_ESP8266) && !defined(USE_RP2040) && !defined(USE_LIBRETINY)
+#define WATERFURNACE_BUS_THREAD
+#include <thread>
+#endif
+
+namespace esphome {
+namespace waterfurnace {
+
+/// The serial line as the bus worker sees it. Every call comes from the worker's thread.
+class BusPort {
+ public:
+  virtual ~BusPort() = default;
+  /// Queue bytes for transmission without waiting for them to go out
+  virtual void write(const uint8_t *data, size_t len) = 0;
+  /// Take whatever has arrived, up to max bytes, without waiting
+  virtual size_t read(uint8_t *data, size_t max) = 0;
+  /// Drive the transceiver's DE pin (nothing to do with auto-direction hardware)
+  virtual void set_transmit(bool /*transmit*/) {}
+  virtual uint32_t micros() = 0;
+  /// Give up the CPU for a moment while nothing is happening on the bus
+  virtual void yield() = 0;
+};
+
+/// A request for the worker: the frame to send and what to expect back
+struct BusRequest {
+  uint32_t id{0};
+  uint16_t len{0};
+  uint16_t response_len{0};  // Length of a successful response
+  uint32_t timeout_us{0};    // From the end of transmission
+  uint8_t frame[MAX_FRAME_SIZE];
+};
+
+/// How a request ended
+enum class BusStatus : uint8_t {
+  RESPONSE,   // frame holds the response (or an exception for the request)
+  TIMEOUT,    // Nothing that answers the request within timeout_us
+  MALFORMED,  // The line went idle on bytes that are not a valid frame
+};
+
+struct BusResult {
+  uint32_t id{0};
+  BusStatus status{BusStatus::TIMEOUT};
+  uint16_t len{0};
+  uint32_t sent_us{0};      // End of transmission
+  uint32_t received_us{0};  // When the response was complete
+  // Receive totals as of this result, for the hub's diagnostics
+  uint32_t skipped_bytes{0};
+  uint32_t length_frames{0};
+  uint32_t idle_frames{0};
+  uint32_t stale_responses{0};
+  uint8_t frame[MAX_FRAME_SIZE];
+};
+
+/// Runs request/response exchanges on the bus from a thread of its own, so bus timing does
+/// not depend on how long the rest of the main loop takes.
+/// The main loop submit()s requests and poll()s results through lock-free single-producer
+/// single-consumer rings. The worker transmits, releases DE once the frame is out, assembles
+/// the response, checks it answers the request (answers_transaction()) and enforces the
+/// timeout. Requests go on the bus one at a time, in the order submitted. Decoding and
+/// dispatch stay with the main loop.
+class BusWorker {
+ public:
+  BusWorker(BusPort *port, const BusTiming &timing) : port_(port), timing_(timing) {}
+  ~BusWorker() { this->stop(); }
+
+  /// Before start(): how response frames end, and the silence that ends one (us)
+  void set_framing(FramingMode mode, uint32_t idle_us) {
+    this->rx_.set_framing(mode);
+    this->idle_us_ = idle_us;
+  }
+
+  // Main loop side
+  bool submit(const BusRequest &request) { return this->requests_.push(request); }
+  bool poll(BusResult &result) { return this->results_.pop(result); }
+
+  /// Start the worker: a FreeRTOS task pinned to core on ESP32, a std::thread on hosts.
+  /// False if neither is available on this platform.
+  bool start(uint8_t core = 0);
+  /// Stop the worker and wait for its thread or task to exit
+  void stop();
+  bool running() const { return this->running_.load(std::memory_order_acquire); }
+
+  /// One pass of the exchange. Returns false if there was nothing to do, so the caller can
+  /// yield. Called by the worker thread, or directly to drive the worker without one.
+  bool step();
+
+  static constexpr size_t QUEUE_SIZE = 4;
+
+ protected:
+  void run_();
+  void finish_(BusStatus status, size_t len, uint32_t received_us);
+
+  enum class State : uint8_t {
+    IDLE,
+    TRANSMITTING,
+    WAITING_RESPONSE,
+    DELIVERING,  // Result ready, results_ full
+  };
+
+  BusPort *port_;
+  BusTiming timing_;
+  uint32_t idle_us_{20000};
+  State state_{State::IDLE};
+
+  BusRequest request_;
+  Transaction transaction_;
+  BusResult result_;
+  uint32_t tx_done_us_{0};
+  uint32_t last_byte_us_{0};
+  uint32_t stale_responses_{0};
+  FrameAssembler rx_;
+
+  SpscRing<BusRequest, QUEUE_SIZE> requests_;
+  SpscRing<BusResult, QUEUE_SIZE> results_;
+
+  std::atomic<bool> running_{false};
+#ifdef USE_ESP32
+  TaskHandle_t task_{nullptr};
+  TaskHandle_t stopping_{nullptr};  // Task waiting in stop(), notified once the worker exits
+#elif defined(WATERFURNACE_BUS_THREAD)
+  std::thread thread_;
+#endif
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -1,7 +1,7 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import climate
-from esphome.const import CONF_ID
+from esphome.const import CONF_ID, CONF_UPDATE_INTERVAL
 from .. import waterfurnace_ns, WaterFurnace, CONF_WATERFURNACE_ID
 
 DEPENDENCIES = ["waterfurnace"]
@@ -16,6 +16,7 @@ CONFIG_SCHEMA = climate.climate_schema(WaterFurnaceClimate).extend(
     {
         cv.GenerateID(CONF_WATERFURNACE_ID): cv.use_id(WaterFurnace),
         cv.Optional(CONF_ZONE, default=0): cv.int_range(min=0, max=6),
+        cv.Optional(CONF_UPDATE_INTERVAL): cv.positive_time_period_milliseconds,
     }
 ).extend(cv.COMPONENT_SCHEMA)
 
@@ -28,3 +29,5 @@ async def to_code(config):
     parent = await cg.get_variable(config[CONF_WATERFURNACE_ID])
     cg.add(var.set_parent(parent))
     cg.add(var.set_zone(config[CONF_ZONE]))
+    if CONF_UPDATE_INTERVAL in config:
+        cg.add(var.set_update_interval(config[CONF_UPDATE_INTERVAL]))
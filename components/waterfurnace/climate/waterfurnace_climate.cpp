@@ -1,25 +1,40 @@
 #include "waterfurnace_climate.h"
 #include "esphome/core/log.h"
 
+#include <cinttypes>
+
 namespace esphome {
 namespace waterfurnace {
 
 static const char *const TAG = "waterfurnace.climate";
 
 void WaterFurnaceClimate::setup() {
+  uint32_t interval = this->update_interval_;
   if (this->zone_ == 0) {
     // Single zone mode - register for thermostat registers
-    this->parent_->register_listener(REG_AMBIENT_TEMP, [this](uint16_t v) { this->on_ambient_temp_(v); });
-    this->parent_->register_listener(REG_HEATING_SETPOINT, [this](uint16_t v) { this->on_heating_setpoint_(v); });
-    this->parent_->register_listener(REG_COOLING_SETPOINT, [this](uint16_t v) { this->on_cooling_setpoint_(v); });
-    this->parent_->register_listener(REG_MODE_CONFIG, [this](uint16_t v) { this->on_mode_config_(v); });
-    this->parent_->register_listener(REG_FAN_CONFIG, [this](uint16_t v) { this->on_fan_config_(v); });
+    this->parent_->register_listener(REG_AMBIENT_TEMP, [this](uint16_t v) { this->on_ambient_temp_(v); }, interval);
+    this->parent_->register_listener(REG_HEATING_SETPOINT, [this](uint16_t v) { this->on_heating_setpoint_(v); },
+                                     interval);
+    this->parent_->register_listener(REG_COOLING_SETPOINT, [this](uint16_t v) { this->on_cooling_setpoint_(v); },
+                                     interval);
+    this->parent_->register_listener(REG_MODE_CONFIG, [this](uint16_t v) { this->on_mode_config_(v); }, interval);
+    this->parent_->register_listener(REG_FAN_CONFIG, [this](uint16_t v) { this->on_fan_config_(v); }, interval);
+    // Writes are confirmed from the registers the thermostat reports them in
+    this->parent_->register_readback(this->get_mode_write_reg_(), REG_MODE_CONFIG);
+    this->parent_->register_readback(this->get_heating_sp_write_reg_(), REG_HEATING_SETPOINT);
+    this->parent_->register_readback(this->get_cooling_sp_write_reg_(), REG_COOLING_SETPOINT);
+    this->parent_->register_readback(this->get_fan_mode_write_reg_(), REG_FAN_CONFIG);
   } else {
     // IZ2 zone mode
     uint16_t base = REG_IZ2_ZONE_BASE + (this->zone_ - 1) * 3;
-    this->parent_->register_listener(base, [this](uint16_t v) { this->on_ambient_temp_(v); });
-    this->parent_->register_listener(base + 1, [this](uint16_t v) { this->on_iz2_config1_(v); });
-    this->parent_->register_listener(base + 2, [this](uint16_t v) { this->on_iz2_config2_(v); });
+    this->parent_->register_listener(base, [this](uint16_t v) { this->on_ambient_temp_(v); }, interval);
+    this->parent_->register_listener(base + 1, [this](uint16_t v) { this->on_iz2_config1_(v); }, interval);
+    this->parent_->register_listener(base + 2, [this](uint16_t v) { this->on_iz2_config2_(v); }, interval);
+    // config1 holds fan mode and cooling setpoint, config2 mode and heating setpoint
+    this->parent_->register_readback(this->get_mode_write_reg_(), base + 2);
+    this->parent_->register_readback(this->get_heating_sp_write_reg_(), base + 2);
+    this->parent_->register_readback(this->get_cooling_sp_write_reg_(), base + 1);
+    this->parent_->register_readback(this->get_fan_mode_write_reg_(), base + 1);
   }
 }
 
@@ -30,6 +45,8 @@ void WaterFurnaceClimate::dump_config() {
   } else {
     ESP_LOGCONFIG(TAG, "  Zone: %d (IZ2)", this->zone_);
   }
+  if (this->update_interval_ != 0)
+    ESP_LOGCONFIG(TAG, "  Update Interval: %" PRIu32 "ms", this->update_interval_);
 }
 
 climate::ClimateTraits WaterFurnaceClimate::traits() {
@@ -15,6 +15,7 @@ class WaterFurnaceClimate : public climate::Climate, public Component {
 
   void set_parent(WaterFurnace *parent) { parent_ = parent; }
   void set_zone(uint8_t zone) { zone_ = zone; }
+  void set_update_interval(uint32_t update_interval) { update_interval_ = update_interval; }
 
   climate::ClimateTraits traits() override;
   void control(const climate::ClimateCall &call) override;
@@ -39,6 +40,7 @@ class WaterFurnaceClimate : public climate::Climate, public Component {
 
   WaterFurnace *parent_{nullptr};
   uint8_t zone_{0};  // 0 = single zone, 1-6 = IZ2 zone number
+  uint32_t update_interval_{0};  // 0 = hub update_interval
 
   // Cached IZ2 config registers for extracting packed values
   uint16_t iz2_config1_{0};
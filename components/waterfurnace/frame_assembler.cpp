@@ -0,0 +1,169 @@
+#include "frame_assembler.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace waterfurnace {
+
+uint8_t *FrameAssembler::write_ptr(size_t &contiguous) {
+  size_t pos = this->head_ & MASK;
+  contiguous = std::min(this->free_space(), RING_SIZE - pos);
+  return this->ring_ + pos;
+}
+
+void FrameAssembler::commit(size_t len) { this->head_ += std::min(len, this->free_space()); }
+
+size_t FrameAssembler::write(const uint8_t *data, size_t len) {
+  size_t written = 0;
+  while (written < len) {
+    size_t contiguous;
+    uint8_t *dst = this->write_ptr(contiguous);
+    size_t n = std::min(contiguous, len - written);
+    if (n == 0)
+      break;
+    std::memcpy(dst, data + written, n);
+    this->commit(n);
+    written += n;
+  }
+  return written;
+}
+
+bool FrameAssembler::plausible_header(const uint8_t *header, size_t available) {
+  if (available >= 1 && header[0] != SLAVE_ADDRESS)
+    return false;
+  if (available < 2)
+    return true;
+
+  uint8_t func_code = header[1] & ~ERROR_MASK;
+  switch (func_code) {
+    case FUNC_READ_RANGES:
+    case FUNC_READ_REGISTERS:
+      // Whole registers, never more than one request can ask for
+      if (available >= 3 && !is_error_response(header[1]))
+        return header[2] % 2 == 0 && header[2] <= MAX_REGISTERS_PER_REQUEST * 2;
+      return true;
+    case FUNC_WRITE_REGISTERS:
+    case FUNC_WRITE_SINGLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t FrameAssembler::expected_length(const uint8_t *header, size_t available) {
+  if (available < 2)
+    return 0;
+  uint8_t func_code = header[1];
+
+  // Error response: slave + func + error code + CRC(2)
+  if (is_error_response(func_code))
+    return 5;
+
+  switch (func_code) {
+    case FUNC_WRITE_REGISTERS:
+      // Minimal echo response: slave + func + CRC(2)
+      return 4;
+    case FUNC_WRITE_SINGLE:
+      // Echo: slave + func + addr(2) + value(2) + CRC(2)
+      return 8;
+    case FUNC_READ_RANGES:
+    case FUNC_READ_REGISTERS:
+    default:
+      // Variable length (unknown functions are assumed to be too):
+      // slave + func + byte_count + data[byte_count] + CRC(2)
+      if (available < 3)
+        return 0;
+      return 3 + header[2] + 2;
+  }
+}
+
+size_t FrameAssembler::poll(uint8_t *frame) {
+  if (this->framing_ == FramingMode::IDLE)
+    return 0;
+
+  while (true) {
+    size_t buffered = this->buffered();
+
+    if (this->expected_ == 0) {
+      uint8_t header[3];
+      size_t n = std::min<size_t>(buffered, sizeof(header));
+      for (size_t i = 0; i < n; i++)
+        header[i] = this->at(i);
+      if (!plausible_header(header, n)) {
+        // Noise: slide forward one byte and look again
+        this->skip(1);
+        continue;
+      }
+      this->expected_ = expected_length(header, n);
+      if (this->expected_ == 0)
+        return 0;
+    }
+
+    // Fold newly arrived bytes of this frame into the running CRC
+    size_t end = std::min(buffered, this->expected_);
+    for (; this->scanned_ < end; this->scanned_++) {
+      uint8_t byte = this->at(this->scanned_);
+      this->crc_ = crc16_update(this->crc_, &byte, 1);
+    }
+    if (this->scanned_ < this->expected_)
+      return 0;
+
+    // Frame complete: a CRC over the frame including its own CRC bytes is zero
+    size_t len = this->expected_;
+    if (this->crc_ == 0) {
+      this->copy_out(frame, len);
+      this->consume(len);
+      this->length_frames_++;
+      return len;
+    }
+    // Not a frame after all; a real one may start at any later byte, so resume scanning
+    // right after this candidate's first byte
+    this->crc_errors_++;
+    this->skip(1);
+  }
+}
+
+size_t FrameAssembler::close(uint8_t *frame) {
+  size_t len = this->buffered();
+  if (len == 0 || this->framing_ == FramingMode::LENGTH)
+    return 0;
+
+  // The buffered bytes are at most two contiguous runs of the ring
+  size_t pos = this->tail_ & MASK;
+  size_t first = std::min(len, RING_SIZE - pos);
+  uint16_t crc = crc16_update(CRC16_INIT, this->ring_ + pos, first);
+  crc = crc16_update(crc, this->ring_, len - first);
+
+  if (len >= MIN_FRAME_SIZE && len <= MAX_FRAME_SIZE && crc == 0) {
+    this->copy_out(frame, len);
+    this->consume(len);
+    this->idle_frames_++;
+    return len;
+  }
+  this->malformed_frames_++;
+  this->skip(len);
+  return 0;
+}
+
+void FrameAssembler::reset() {
+  this->tail_ = this->head_;
+  this->consume(0);
+}
+
+void FrameAssembler::copy_out(uint8_t *frame, size_t len) const {
+  size_t pos = this->tail_ & MASK;
+  size_t first = std::min(len, RING_SIZE - pos);
+  std::memcpy(frame, this->ring_ + pos, first);
+  std::memcpy(frame + first, this->ring_, len - first);
+}
+
+void FrameAssembler::consume(size_t len) {
+  this->tail_ += len;
+  this->scanned_ = 0;
+  this->expected_ = 0;
+  this->crc_ = CRC16_INIT;
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
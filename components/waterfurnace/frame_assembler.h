@@ -0,0 +1,114 @@
+#pragma once
+
+#include "protocol.h"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome {
+namespace waterfurnace {
+
+/// How the end of a response frame is found
+enum class FramingMode : uint8_t {
+  LENGTH,  // From the function code and byte count in the header
+  IDLE,    // The line going quiet for t3.5 (ModBus RTU character timeout)
+  AUTO,    // Whichever comes first
+};
+
+/// Response frame assembly over a fixed-size receive ring.
+/// The UART is drained straight into the ring with bulk reads (write_ptr() + commit()).
+/// poll() only looks at bytes that arrived since its last call: the header is parsed once,
+/// the expected length remembered and the CRC folded in as bytes arrive, so completing a
+/// frame costs O(new bytes) however slowly it trickles in.
+///
+/// The stream resynchronizes on noise: bytes that cannot start a response (wrong slave
+/// address, unknown function code, impossible byte count) are skipped, and when a complete
+/// candidate fails its CRC only its first byte is dropped, so a real response that started
+/// inside it is still found in the same pass.
+///
+/// The assembler has no clock: in IDLE and AUTO framing the owner calls close() once the
+/// line has been silent long enough, which ends the frame at whatever has arrived.
+class FrameAssembler {
+ public:
+  void set_framing(FramingMode mode) { this->framing_ = mode; }
+  FramingMode framing() const { return this->framing_; }
+
+  /// Ring capacity (power of two), room for two maximum-size frames
+  static constexpr size_t RING_SIZE = 2 * MAX_FRAME_SIZE;
+
+  /// Contiguous free space at the write position, for a bulk read straight into the ring.
+  /// Returns the write pointer; contiguous is set to how many bytes may be written there.
+  uint8_t *write_ptr(size_t &contiguous);
+  /// Mark len bytes written at write_ptr() as received
+  void commit(size_t len);
+  /// Copy bytes into the ring, returns how many fit
+  size_t write(const uint8_t *data, size_t len);
+
+  /// Advance assembly over the new bytes. When a frame with a valid CRC is complete it is
+  /// copied to frame (MAX_FRAME_SIZE bytes) and its length returned; otherwise 0.
+  /// Always 0 in IDLE framing.
+  size_t poll(uint8_t *frame);
+
+  /// The line went idle: everything buffered is one frame. Returns its length if the CRC
+  /// checks out; otherwise the bytes are dropped as a malformed frame and 0 is returned.
+  /// Does nothing in LENGTH framing.
+  size_t close(uint8_t *frame);
+
+  /// Drop everything buffered (before sending a new request)
+  void reset();
+
+  size_t buffered() const { return this->head_ - this->tail_; }
+  size_t free_space() const { return RING_SIZE - this->buffered(); }
+
+  /// Candidate frames whose CRC did not match
+  uint32_t crc_errors() const { return this->crc_errors_; }
+  /// Bytes discarded while looking for the start of a valid frame
+  uint32_t skipped_bytes() const { return this->skipped_bytes_; }
+  /// Frames completed by poll() (header length) and by close() (idle line)
+  uint32_t length_frames() const { return this->length_frames_; }
+  uint32_t idle_frames() const { return this->idle_frames_; }
+  /// Idle-delimited frames dropped because they were not a valid response
+  uint32_t malformed_frames() const { return this->malformed_frames_; }
+
+  /// False if the first `available` bytes cannot be the start of a response to us
+  static bool plausible_header(const uint8_t *header, size_t available);
+
+  /// Total frame length implied by a response header, 0 if more header bytes are needed.
+  /// header holds the first `available` bytes of the frame.
+  static size_t expected_length(const uint8_t *header, size_t available);
+
+ protected:
+  static constexpr size_t MASK = RING_SIZE - 1;
+  static_assert((RING_SIZE & MASK) == 0, "RING_SIZE must be a power of two");
+
+  uint8_t at(size_t offset) const { return this->ring_[(this->tail_ + offset) & MASK]; }
+  void copy_out(uint8_t *frame, size_t len) const;
+  // Drop len bytes from the front of the ring and restart assembly after them
+  void consume(size_t len);
+  // Same, for bytes that turned out not to belong to a frame
+  void skip(size_t len) {
+    this->skipped_bytes_ += len;
+    this->consume(len);
+  }
+
+  FramingMode framing_{FramingMode::LENGTH};
+
+  uint8_t ring_[RING_SIZE];
+  // Free-running positions; masked on access
+  size_t head_{0};
+  size_t tail_{0};
+
+  // Current candidate frame, which starts at tail_
+  size_t scanned_{0};   // Bytes already folded into crc_
+  size_t expected_{0};  // Total length once the header is known, 0 before
+  uint16_t crc_{CRC16_INIT};
+
+  uint32_t crc_errors_{0};
+  uint32_t skipped_bytes_{0};
+  uint32_t length_frames_{0};
+  uint32_t idle_frames_{0};
+  uint32_t malformed_frames_{0};
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,50 @@
+#include "listener_table.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace waterfurnace {
+
+void ListenerTable::add(RegisterListener listener) {
+  this->listeners_.push_back(std::move(listener));
+  this->frozen_ = false;
+}
+
+void ListenerTable::freeze() {
+  if (this->frozen_)
+    return;
+  std::stable_sort(this->listeners_.begin(), this->listeners_.end(),
+                   [](const RegisterListener &a, const RegisterListener &b) { return a.address < b.address; });
+
+  this->addresses_.clear();
+  this->spans_.clear();
+  for (size_t i = 0; i < this->listeners_.size(); i++) {
+    uint16_t address = this->listeners_[i].address;
+    if (this->addresses_.empty() || this->addresses_.back() != address) {
+      this->addresses_.push_back(address);
+      this->spans_.push_back({static_cast<uint16_t>(i), static_cast<uint16_t>(i)});
+    }
+    this->spans_.back().end = static_cast<uint16_t>(i + 1);
+  }
+  this->addresses_.shrink_to_fit();
+  this->spans_.shrink_to_fit();
+  this->frozen_ = true;
+}
+
+ListenerSpan ListenerTable::find(uint16_t address) const {
+  auto it = std::lower_bound(this->addresses_.begin(), this->addresses_.end(), address);
+  if (it == this->addresses_.end() || *it != address)
+    return {};
+  return this->spans_[it - this->addresses_.begin()];
+}
+
+std::vector<ListenerSpan> ListenerTable::resolve(const std::vector<uint16_t> &addresses) const {
+  std::vector<ListenerSpan> spans;
+  spans.reserve(addresses.size());
+  for (uint16_t address : addresses)
+    spans.push_back(this->find(address));
+  return spans;
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
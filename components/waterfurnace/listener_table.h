@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace waterfurnace {
+
+struct RegisterListener {
+  uint16_t address;
+  std::function<void(uint16_t)> callback;
+  uint32_t update_interval{0};     // ms, 0 = hub update_interval
+  bool dispatch_unchanged{false};  // Called on every sample, not only on change
+  uint8_t count{1};                // Consecutive registers watched (2 for 32-bit values)
+  // What a multi-register listener was last called with. Another rate may poll one of its
+  // registers and clear that register's change flag first, so it keeps its own.
+  uint32_t last_words{0};
+  bool has_words{false};
+};
+
+/// Contiguous run of listeners [begin, end) that share one register address
+struct ListenerSpan {
+  uint16_t begin{0};
+  uint16_t end{0};
+
+  bool empty() const { return begin == end; }
+};
+
+/// Register listeners grouped by address.
+/// Listeners are added during setup; freeze() sorts them by address so every address owns a
+/// contiguous span. Spans are resolved once per poll group, so dispatching a response is a
+/// direct walk over each position's span instead of a search through every listener.
+class ListenerTable {
+ public:
+  /// Append a listener. Unfreezes the table; spans resolved earlier keep pointing at the
+  /// listeners they covered until the next freeze().
+  void add(RegisterListener listener);
+
+  /// Sort listeners by address (registration order kept within an address) and build the index
+  void freeze();
+  bool is_frozen() const { return this->frozen_; }
+
+  /// Listeners on one address. The table must be frozen.
+  ListenerSpan find(uint16_t address) const;
+
+  /// Span for every address in a response, in response order. The table must be frozen.
+  std::vector<ListenerSpan> resolve(const std::vector<uint16_t> &addresses) const;
+
+  RegisterListener &operator[](size_t index) { return this->listeners_[index]; }
+  const RegisterListener &operator[](size_t index) const { return this->listeners_[index]; }
+  size_t size() const { return this->listeners_.size(); }
+
+  std::vector<RegisterListener>::const_iterator begin() const { return this->listeners_.begin(); }
+  std::vector<RegisterListener>::const_iterator end() const { return this->listeners_.end(); }
+
+ protected:
+  std::vector<RegisterListener> listeners_;
+  // Sorted unique addresses, parallel to spans_
+  std::vector<uint16_t> addresses_;
+  std::vector<ListenerSpan> spans_;
+  bool frozen_{true};
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
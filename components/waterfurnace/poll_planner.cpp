@@ -0,0 +1,318 @@
+#include "poll_planner.h"
+#include "protocol.h"
+#include "registers.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace waterfurnace {
+
+// Bytes needed to describe one extra range in a function 65 request (address + quantity)
+static constexpr size_t RANGE_DESCRIPTOR_SIZE = 4;
+// Most ranges a function 65 request can carry within MAX_FRAME_SIZE
+static constexpr size_t MAX_RANGES_PER_REQUEST = (MAX_FRAME_SIZE - 4) / RANGE_DESCRIPTOR_SIZE;
+
+uint32_t char_time_us(const BusTiming &timing) {
+  return (timing.bits_per_char * 1000000UL + timing.baud_rate - 1) / timing.baud_rate;
+}
+
+uint32_t silent_interval_us(const BusTiming &timing) {
+  if (timing.baud_rate > 19200)
+    return 1750;
+  return (timing.bits_per_char * 3500000UL + timing.baud_rate - 1) / timing.baud_rate;
+}
+
+size_t read_ranges_request_size(size_t num_ranges) {
+  // slave + func + ranges + CRC(2)
+  return 2 + num_ranges * RANGE_DESCRIPTOR_SIZE + 2;
+}
+
+size_t read_registers_request_size(size_t num_registers) {
+  // slave + func + addresses + CRC(2)
+  return 2 + num_registers * 2 + 2;
+}
+
+size_t read_response_size(size_t num_registers) {
+  // slave + func + byte_count + data + CRC(2)
+  return 3 + num_registers * 2 + 2;
+}
+
+uint32_t estimate_read_ranges_us(const RegisterRanges &ranges, const BusTiming &timing) {
+  size_t bytes = read_ranges_request_size(ranges.size()) + read_response_size(count_registers(ranges));
+  return bytes * char_time_us(timing) + timing.inter_frame_delay_us + timing.turnaround_us;
+}
+
+uint32_t estimate_plan_us(const std::vector<RegisterRanges> &plan, const BusTiming &timing) {
+  uint32_t total = 0;
+  for (const auto &ranges : plan)
+    total += estimate_read_ranges_us(ranges, timing);
+  return total;
+}
+
+size_t count_registers(const RegisterRanges &ranges) {
+  size_t total = 0;
+  for (const auto &range : ranges)
+    total += range.second;
+  return total;
+}
+
+// True if [start, end) contains a breakpoint anywhere but at its first address
+static bool crosses_breakpoint(uint32_t start, uint32_t end) {
+  for (size_t i = 0; i < READ_BREAKPOINTS_SIZE; i++) {
+    if (start < READ_BREAKPOINTS[i] && READ_BREAKPOINTS[i] < end)
+      return true;
+  }
+  return false;
+}
+
+RegisterRanges normalize_ranges(const RegisterRanges &ranges) {
+  // Work with [start, end) intervals so ranges ending at 0xFFFF don't overflow
+  std::vector<std::pair<uint32_t, uint32_t>> intervals;
+  intervals.reserve(ranges.size());
+  for (const auto &range : ranges) {
+    if (range.second > 0)
+      intervals.push_back({range.first, static_cast<uint32_t>(range.first) + range.second});
+  }
+  std::sort(intervals.begin(), intervals.end());
+
+  RegisterRanges result;
+  auto emit = [&result](uint32_t start, uint32_t end) {
+    // Split at breakpoints
+    for (size_t i = 0; i < READ_BREAKPOINTS_SIZE; i++) {
+      uint32_t bp = READ_BREAKPOINTS[i];
+      if (start < bp && bp < end) {
+        result.push_back({static_cast<uint16_t>(start), static_cast<uint16_t>(bp - start)});
+        start = bp;
+      }
+    }
+    result.push_back({static_cast<uint16_t>(start), static_cast<uint16_t>(end - start)});
+  };
+
+  size_t i = 0;
+  while (i < intervals.size()) {
+    uint32_t start = intervals[i].first;
+    uint32_t end = intervals[i].second;
+    for (i++; i < intervals.size() && intervals[i].first <= end; i++)
+      end = std::max(end, intervals[i].second);
+    emit(start, end);
+  }
+  return result;
+}
+
+// True if any excluded register lies in [start, end)
+static bool contains_excluded(const std::vector<uint16_t> &excluded, uint32_t start, uint32_t end) {
+  auto it = std::lower_bound(excluded.begin(), excluded.end(), start);
+  return it != excluded.end() && *it < end;
+}
+
+RegisterRanges coalesce_ranges(const RegisterRanges &ranges, const std::vector<uint16_t> &excluded) {
+  RegisterRanges normalized = normalize_ranges(ranges);
+  RegisterRanges result;
+  // Every byte costs the same wire time, so compare bytes: the gap's registers travel in the
+  // response (2 bytes each), a separate range costs one descriptor in the request.
+  for (const auto &range : normalized) {
+    if (!result.empty()) {
+      auto &last = result.back();
+      uint32_t last_end = static_cast<uint32_t>(last.first) + last.second;
+      uint32_t gap = range.first - last_end;
+      uint32_t merged = range.first + range.second - last.first;
+      if (gap * 2 < RANGE_DESCRIPTOR_SIZE && merged <= MAX_REGISTERS_PER_REQUEST &&
+          !crosses_breakpoint(last.first, static_cast<uint32_t>(range.first) + range.second) &&
+          !contains_excluded(excluded, last_end, range.first)) {
+        last.second = static_cast<uint16_t>(merged);
+        continue;
+      }
+    }
+    result.push_back(range);
+  }
+  return result;
+}
+
+RegisterRanges select_registers(const RegisterRanges &available, const std::vector<uint16_t> &addresses) {
+  RegisterRanges selected;
+  for (uint16_t addr : addresses) {
+    for (const auto &range : available) {
+      if (addr >= range.first && addr - range.first < range.second) {
+        selected.push_back({addr, 1});
+        break;
+      }
+    }
+  }
+  return normalize_ranges(selected);
+}
+
+// How many of a range's registers from start to take, at most qty of the remaining ones,
+// without cutting between the two words of a pair (may be 0)
+static uint32_t keep_pairs(uint32_t start, uint32_t qty, uint32_t remaining, const std::vector<uint16_t> &pairs) {
+  if (qty == 0 || qty >= remaining || !std::binary_search(pairs.begin(), pairs.end(), start + qty - 1))
+    return qty;
+  return qty - 1;
+}
+
+// Limit each range to what fits in a single request
+static RegisterRanges chunk_ranges(const RegisterRanges &ranges, const std::vector<uint16_t> &pairs) {
+  RegisterRanges result;
+  for (const auto &range : ranges) {
+    uint32_t start = range.first;
+    uint32_t remaining = range.second;
+    while (remaining > 0) {
+      uint32_t qty = keep_pairs(start, std::min<uint32_t>(remaining, MAX_REGISTERS_PER_REQUEST), remaining, pairs);
+      result.push_back({static_cast<uint16_t>(start), static_cast<uint16_t>(qty)});
+      start += qty;
+      remaining -= qty;
+    }
+  }
+  return result;
+}
+
+static size_t min_frames(const RegisterRanges &ranges) {
+  size_t by_registers = (count_registers(ranges) + MAX_REGISTERS_PER_REQUEST - 1) / MAX_REGISTERS_PER_REQUEST;
+  size_t by_ranges = (ranges.size() + MAX_RANGES_PER_REQUEST - 1) / MAX_RANGES_PER_REQUEST;
+  return std::max(by_registers, by_ranges);
+}
+
+// First-fit decreasing: keeps every range whole
+static std::vector<RegisterRanges> pack_whole(RegisterRanges ranges) {
+  std::stable_sort(ranges.begin(), ranges.end(),
+                   [](const std::pair<uint16_t, uint16_t> &a, const std::pair<uint16_t, uint16_t> &b) {
+                     return a.second > b.second;
+                   });
+  std::vector<RegisterRanges> frames;
+  std::vector<size_t> used;
+  for (const auto &range : ranges) {
+    size_t f = 0;
+    for (; f < frames.size(); f++) {
+      if (used[f] + range.second <= MAX_REGISTERS_PER_REQUEST && frames[f].size() < MAX_RANGES_PER_REQUEST)
+        break;
+    }
+    if (f == frames.size()) {
+      frames.emplace_back();
+      used.push_back(0);
+    }
+    frames[f].push_back(range);
+    used[f] += range.second;
+  }
+  return frames;
+}
+
+// Fill each request to capacity in address order, splitting ranges at request boundaries
+// (never inside a pair)
+static std::vector<RegisterRanges> pack_split(const RegisterRanges &ranges, const std::vector<uint16_t> &pairs) {
+  std::vector<RegisterRanges> frames;
+  size_t used = MAX_REGISTERS_PER_REQUEST;
+  for (const auto &range : ranges) {
+    uint32_t start = range.first;
+    uint32_t remaining = range.second;
+    while (remaining > 0) {
+      if (used == MAX_REGISTERS_PER_REQUEST || frames.back().size() == MAX_RANGES_PER_REQUEST) {
+        frames.emplace_back();
+        used = 0;
+      }
+      uint32_t room = MAX_REGISTERS_PER_REQUEST - used;
+      uint32_t qty = keep_pairs(start, std::min<uint32_t>(remaining, room), remaining, pairs);
+      if (qty == 0) {
+        // Only the first word of a pair would fit: it goes in the next request with the second
+        used = MAX_REGISTERS_PER_REQUEST;
+        continue;
+      }
+      frames.back().push_back({static_cast<uint16_t>(start), static_cast<uint16_t>(qty)});
+      used += qty;
+      start += qty;
+      remaining -= qty;
+    }
+  }
+  return frames;
+}
+
+static std::vector<RegisterRanges> pack_ranges(const RegisterRanges &ranges, const std::vector<uint16_t> &pairs) {
+  RegisterRanges chunked = chunk_ranges(ranges, pairs);
+  // Prefer whole ranges (multi-register values stay in one response); only split when
+  // that saves a transaction
+  auto frames = pack_whole(chunked);
+  if (frames.size() > min_frames(chunked)) {
+    auto split = pack_split(chunked, pairs);
+    if (split.size() < frames.size())
+      frames = std::move(split);
+  }
+  for (auto &frame : frames)
+    std::sort(frame.begin(), frame.end());
+  std::sort(frames.begin(), frames.end());
+  return frames;
+}
+
+std::vector<RegisterRanges> plan_read_ranges(const RegisterRanges &ranges, const BusTiming &timing,
+                                             const std::vector<uint16_t> &excluded,
+                                             const std::vector<uint16_t> &pairs) {
+  auto bridged = pack_ranges(coalesce_ranges(ranges, excluded), pairs);
+  auto exact = pack_ranges(normalize_ranges(ranges), pairs);
+  // Bridging can push a plan over a request boundary; keep whichever is cheaper overall
+  if (estimate_plan_us(exact, timing) < estimate_plan_us(bridged, timing))
+    return exact;
+  return bridged;
+}
+
+void append_addresses(const RegisterRanges &ranges, std::vector<uint16_t> &addresses) {
+  for (const auto &range : ranges) {
+    for (uint16_t i = 0; i < range.second; i++)
+      addresses.push_back(range.first + i);
+  }
+}
+
+// Any page of at most MAX_REGISTERS_PER_REQUEST fits both the byte count and the frame
+static_assert(MAX_REGISTERS_PER_REQUEST * 2 <= 255, "A full page must fit the one-byte byte count");
+static_assert(3 + MAX_REGISTERS_PER_REQUEST * 2 + 2 <= MAX_FRAME_SIZE, "A full page response must fit a frame");
+static_assert(2 + MAX_REGISTERS_PER_REQUEST * 2 + 2 <= MAX_FRAME_SIZE, "A full func 66 request must fit a frame");
+
+std::vector<ReadPage> paginate_read(const RegisterRanges &ranges, const std::vector<uint16_t> &individual) {
+  std::vector<ReadPage> pages;
+  std::vector<ReadPage> singles;  // Func 66, merged below
+  std::vector<uint16_t> covered;
+  for (auto &frame : pack_ranges(normalize_ranges(ranges), {})) {
+    ReadPage page;
+    append_addresses(frame, page.addresses);
+    covered.insert(covered.end(), page.addresses.begin(), page.addresses.end());
+    // Mostly single registers are cheaper to list than to describe as ranges
+    if (read_registers_request_size(page.addresses.size()) < read_ranges_request_size(frame.size())) {
+      page.func_code = FUNC_READ_REGISTERS;
+      singles.push_back(std::move(page));
+    } else {
+      page.func_code = FUNC_READ_RANGES;
+      page.ranges = std::move(frame);
+      pages.push_back(std::move(page));
+    }
+  }
+
+  std::sort(covered.begin(), covered.end());
+  std::vector<uint16_t> rest = individual;
+  std::sort(rest.begin(), rest.end());
+  rest.erase(std::unique(rest.begin(), rest.end()), rest.end());
+  auto is_covered = [&covered](uint16_t addr) { return std::binary_search(covered.begin(), covered.end(), addr); };
+  rest.erase(std::remove_if(rest.begin(), rest.end(), is_covered), rest.end());
+  for (size_t i = 0; i < rest.size(); i += MAX_REGISTERS_PER_REQUEST) {
+    ReadPage page;
+    page.func_code = FUNC_READ_REGISTERS;
+    page.addresses.assign(rest.begin() + i, rest.begin() + std::min(rest.size(), i + MAX_REGISTERS_PER_REQUEST));
+    singles.push_back(std::move(page));
+  }
+
+  // First-fit: every func 66 page saved is a header, a CRC and a turnaround
+  std::vector<ReadPage> merged;
+  for (auto &page : singles) {
+    auto it = std::find_if(merged.begin(), merged.end(), [&page](const ReadPage &m) {
+      return m.addresses.size() + page.addresses.size() <= MAX_REGISTERS_PER_REQUEST;
+    });
+    if (it == merged.end()) {
+      merged.push_back(std::move(page));
+    } else {
+      it->addresses.insert(it->addresses.end(), page.addresses.begin(), page.addresses.end());
+    }
+  }
+  for (auto &page : merged) {
+    std::sort(page.addresses.begin(), page.addresses.end());
+    pages.push_back(std::move(page));
+  }
+  return pages;
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace waterfurnace {
+
+using RegisterRanges = std::vector<std::pair<uint16_t, uint16_t>>;
+
+/// Bus timing used by the poll planner's cost model.
+/// Defaults match the Aurora AID port: 19200 baud, 8E1 (start + 8 data + parity + stop = 11 bits).
+struct BusTiming {
+  uint32_t baud_rate{19200};
+  uint8_t bits_per_char{11};
+  uint32_t inter_frame_delay_us{5000};  // Gap we leave before every request
+  uint32_t turnaround_us{20000};        // Typical ABC board processing time before it answers
+};
+
+/// Time on the wire for a single character, in microseconds
+uint32_t char_time_us(const BusTiming &timing);
+
+/// Silence that ends an RTU frame (t3.5): 3.5 character times, fixed at 1750 us above
+/// 19200 baud as the ModBus serial line spec recommends
+uint32_t silent_interval_us(const BusTiming &timing);
+
+/// Request size for a function 65 frame with the given number of ranges
+size_t read_ranges_request_size(size_t num_ranges);
+
+/// Request size for a function 66 frame with the given number of registers
+size_t read_registers_request_size(size_t num_registers);
+
+/// Response size for a function 65/66 frame carrying the given number of registers
+size_t read_response_size(size_t num_registers);
+
+/// Estimated bus time of one function 65 transaction (request, turnaround, response, gap)
+uint32_t estimate_read_ranges_us(const RegisterRanges &ranges, const BusTiming &timing);
+
+/// Estimated bus time of a complete plan (sum of its transactions)
+uint32_t estimate_plan_us(const std::vector<RegisterRanges> &plan, const BusTiming &timing);
+
+/// Total number of registers covered by a set of ranges
+size_t count_registers(const RegisterRanges &ranges);
+
+/// Append every address covered by ranges, in order (the order a func 65 response returns them)
+void append_addresses(const RegisterRanges &ranges, std::vector<uint16_t> &addresses);
+
+/// Sort ranges, merge overlapping/adjacent ones and split any range that crosses
+/// a read breakpoint (see READ_BREAKPOINTS in registers.h)
+RegisterRanges normalize_ranges(const RegisterRanges &ranges);
+
+/// Normalize, then bridge small gaps between neighbouring ranges wherever reading the
+/// unused registers costs fewer bytes than describing a separate range.
+/// Gaps are never bridged across a read breakpoint or over an excluded register (sorted).
+RegisterRanges coalesce_ranges(const RegisterRanges &ranges, const std::vector<uint16_t> &excluded = {});
+
+/// Narrow a set of available ranges down to the given addresses.
+/// Addresses outside every available range are dropped; the result is normalized.
+RegisterRanges select_registers(const RegisterRanges &available, const std::vector<uint16_t> &addresses);
+
+/// Pack ranges into as few function 65 requests as possible.
+/// Each request stays within MAX_REGISTERS_PER_REQUEST and MAX_FRAME_SIZE, and ranges
+/// never cross a read breakpoint. Gap bridging is only kept when it lowers the estimated
+/// bus time of the whole plan. Registers in excluded (sorted) are never read as bridging.
+/// Registers in pairs (sorted) are the first word of a 32-bit value: a range is never split
+/// between one of them and the register after it, so both words arrive in the same response.
+std::vector<RegisterRanges> plan_read_ranges(const RegisterRanges &ranges, const BusTiming &timing = {},
+                                             const std::vector<uint16_t> &excluded = {},
+                                             const std::vector<uint16_t> &pairs = {});
+
+/// One request of a paginated read
+struct ReadPage {
+  uint8_t func_code{0};             // FUNC_READ_RANGES or FUNC_READ_REGISTERS
+  RegisterRanges ranges;            // Requested ranges (func 65 only)
+  std::vector<uint16_t> addresses;  // Response order; the request itself for func 66
+};
+
+/// Split a read of ranges plus individual registers into as many requests as it takes.
+/// Every page stays within MAX_REGISTERS_PER_REQUEST, the one-byte byte count and
+/// MAX_FRAME_SIZE. A page of ranges is sent as func 65 or 66, whichever request is smaller;
+/// individual registers are always read with func 66, and func 66 pages are merged as far
+/// as they fit. Addresses already covered by a range are not read again.
+std::vector<ReadPage> paginate_read(const RegisterRanges &ranges, const std::vector<uint16_t> &individual = {});
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -3,13 +3,50 @@
 namespace esphome {
 namespace waterfurnace {
 
-uint16_t crc16(const uint8_t *data, size_t len) {
-  uint16_t crc = 0xFFFF;
+// CRC16 lookup tables, generated at compile time.
+// tables[0][b] is the CRC of a single byte b; tables[k][b] advances tables[k-1][b] by one more
+// zero byte, so four input bytes can be folded in with four independent lookups.
+struct Crc16Tables {
+  uint16_t tables[4][256];
+};
+
+static constexpr Crc16Tables make_crc16_tables() {
+  Crc16Tables t{};
+  for (uint16_t b = 0; b < 256; b++) {
+    uint16_t crc = b;
+    for (int j = 0; j < 8; j++)
+      crc = (crc & 0x0001) ? (crc >> 1) ^ CRC16_POLY : crc >> 1;
+    t.tables[0][b] = crc;
+  }
+  for (int k = 1; k < 4; k++) {
+    for (uint16_t b = 0; b < 256; b++) {
+      uint16_t prev = t.tables[k - 1][b];
+      t.tables[k][b] = (prev >> 8) ^ t.tables[0][prev & 0xFF];
+    }
+  }
+  return t;
+}
+
+static constexpr Crc16Tables CRC16_TABLES = make_crc16_tables();
+
+static_assert(CRC16_TABLES.tables[0][1] == 0xC0C1, "CRC16 table generation");
+
+uint16_t crc16(const uint8_t *data, size_t len) { return crc16_slice4(data, len); }
+
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len) {
+  const auto &table = CRC16_TABLES.tables[0];
+  for (size_t i = 0; i < len; i++)
+    crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+  return crc;
+}
+
+uint16_t crc16_bitwise(const uint8_t *data, size_t len) {
+  uint16_t crc = CRC16_INIT;
   for (size_t i = 0; i < len; i++) {
     crc ^= data[i];
     for (int j = 0; j < 8; j++) {
       if (crc & 0x0001) {
-        crc = (crc >> 1) ^ 0xA001;
+        crc = (crc >> 1) ^ CRC16_POLY;
       } else {
         crc >>= 1;
       }
@@ -18,74 +55,126 @@ uint16_t crc16(const uint8_t *data, size_t len) {
   return crc;
 }
 
-static void append_crc(std::vector<uint8_t> &frame) {
-  uint16_t crc = crc16(frame.data(), frame.size());
-  frame.push_back(crc & 0xFF);         // CRC low byte first (ModBus convention)
-  frame.push_back((crc >> 8) & 0xFF);  // CRC high byte second
+uint16_t crc16_table(const uint8_t *data, size_t len) { return crc16_update(CRC16_INIT, data, len); }
+
+uint16_t crc16_slice4(const uint8_t *data, size_t len) {
+  const auto &t = CRC16_TABLES.tables;
+  uint16_t crc = CRC16_INIT;
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    // The 16-bit state absorbs the first two bytes; the other two only need their own lookups
+    crc ^= data[i] | (data[i + 1] << 8);
+    crc = t[3][crc & 0xFF] ^ t[2][crc >> 8] ^ t[1][data[i + 2]] ^ t[0][data[i + 3]];
+  }
+  for (; i < len; i++)
+    crc = (crc >> 8) ^ t[0][(crc ^ data[i]) & 0xFF];
+  return crc;
 }
 
-std::vector<uint8_t> build_read_ranges_request(
-    const std::vector<std::pair<uint16_t, uint16_t>> &ranges) {
-  std::vector<uint8_t> frame;
-  frame.push_back(SLAVE_ADDRESS);
-  frame.push_back(FUNC_READ_RANGES);
+// Sequential writer over a caller buffer; overflows are remembered instead of written
+class FrameWriter {
+ public:
+  FrameWriter(uint8_t *frame, size_t capacity) : frame_(frame), capacity_(capacity) {}
+
+  void put(uint8_t byte) {
+    if (this->len_ < this->capacity_) {
+      this->frame_[this->len_] = byte;
+    } else {
+      this->overflow_ = true;
+    }
+    this->len_++;
+  }
+  void put16(uint16_t value) {
+    // Big-endian: high byte first
+    this->put((value >> 8) & 0xFF);
+    this->put(value & 0xFF);
+  }
+
+  // Append the CRC and return the frame length, 0 if it did not fit
+  size_t finish() {
+    if (this->overflow_ || this->len_ + 2 > this->capacity_)
+      return 0;
+    uint16_t crc = crc16(this->frame_, this->len_);
+    this->put(crc & 0xFF);         // CRC low byte first (ModBus convention)
+    this->put((crc >> 8) & 0xFF);  // CRC high byte second
+    return this->len_;
+  }
 
+ protected:
+  uint8_t *frame_;
+  size_t capacity_;
+  size_t len_{0};
+  bool overflow_{false};
+};
+
+size_t build_read_ranges_request(const std::vector<std::pair<uint16_t, uint16_t>> &ranges, uint8_t *frame,
+                                 size_t capacity) {
+  FrameWriter writer(frame, capacity);
+  writer.put(SLAVE_ADDRESS);
+  writer.put(FUNC_READ_RANGES);
   for (const auto &range : ranges) {
-    // Big-endian: address high, address low, quantity high, quantity low
-    frame.push_back((range.first >> 8) & 0xFF);
-    frame.push_back(range.first & 0xFF);
-    frame.push_back((range.second >> 8) & 0xFF);
-    frame.push_back(range.second & 0xFF);
+    writer.put16(range.first);
+    writer.put16(range.second);
+  }
+  return writer.finish();
+}
+
+size_t build_read_registers_request(const std::vector<uint16_t> &addresses, uint8_t *frame, size_t capacity) {
+  FrameWriter writer(frame, capacity);
+  writer.put(SLAVE_ADDRESS);
+  writer.put(FUNC_READ_REGISTERS);
+  for (uint16_t addr : addresses)
+    writer.put16(addr);
+  return writer.finish();
+}
+
+size_t build_write_registers_request(const std::vector<std::pair<uint16_t, uint16_t>> &writes, uint8_t *frame,
+                                     size_t capacity) {
+  FrameWriter writer(frame, capacity);
+  writer.put(SLAVE_ADDRESS);
+  writer.put(FUNC_WRITE_REGISTERS);
+  for (const auto &w : writes) {
+    writer.put16(w.first);
+    writer.put16(w.second);
   }
+  return writer.finish();
+}
+
+size_t build_write_single_request(uint16_t address, uint16_t value, uint8_t *frame, size_t capacity) {
+  FrameWriter writer(frame, capacity);
+  writer.put(SLAVE_ADDRESS);
+  writer.put(FUNC_WRITE_SINGLE);
+  writer.put16(address);
+  writer.put16(value);
+  return writer.finish();
+}
+
+// Vector variants: same bytes, in a vector of exactly the frame's length
 
-  append_crc(frame);
+std::vector<uint8_t> build_read_ranges_request(
+    const std::vector<std::pair<uint16_t, uint16_t>> &ranges) {
+  std::vector<uint8_t> frame(2 + 4 * ranges.size() + 2);
+  build_read_ranges_request(ranges, frame.data(), frame.size());
   return frame;
 }
 
 std::vector<uint8_t> build_read_registers_request(
     const std::vector<uint16_t> &addresses) {
-  std::vector<uint8_t> frame;
-  frame.push_back(SLAVE_ADDRESS);
-  frame.push_back(FUNC_READ_REGISTERS);
-
-  for (uint16_t addr : addresses) {
-    frame.push_back((addr >> 8) & 0xFF);
-    frame.push_back(addr & 0xFF);
-  }
-
-  append_crc(frame);
+  std::vector<uint8_t> frame(2 + 2 * addresses.size() + 2);
+  build_read_registers_request(addresses, frame.data(), frame.size());
   return frame;
 }
 
 std::vector<uint8_t> build_write_registers_request(
     const std::vector<std::pair<uint16_t, uint16_t>> &writes) {
-  std::vector<uint8_t> frame;
-  frame.push_back(SLAVE_ADDRESS);
-  frame.push_back(FUNC_WRITE_REGISTERS);
-
-  for (const auto &w : writes) {
-    // Address big-endian
-    frame.push_back((w.first >> 8) & 0xFF);
-    frame.push_back(w.first & 0xFF);
-    // Value big-endian
-    frame.push_back((w.second >> 8) & 0xFF);
-    frame.push_back(w.second & 0xFF);
-  }
-
-  append_crc(frame);
+  std::vector<uint8_t> frame(2 + 4 * writes.size() + 2);
+  build_write_registers_request(writes, frame.data(), frame.size());
   return frame;
 }
 
 std::vector<uint8_t> build_write_single_request(uint16_t address, uint16_t value) {
-  std::vector<uint8_t> frame;
-  frame.push_back(SLAVE_ADDRESS);
-  frame.push_back(FUNC_WRITE_SINGLE);
-  frame.push_back((address >> 8) & 0xFF);
-  frame.push_back(address & 0xFF);
-  frame.push_back((value >> 8) & 0xFF);
-  frame.push_back(value & 0xFF);
-
-  append_crc(frame);
+  std::vector<uint8_t> frame(2 + 4 + 2);
+  build_write_single_request(address, value, frame.data(), frame.size());
   return frame;
 }
 
@@ -102,6 +191,19 @@ bool is_error_response(uint8_t function_code) {
   return (function_code & ERROR_MASK) != 0;
 }
 
+bool answers_transaction(const Transaction &txn, const uint8_t *frame, size_t len, uint32_t received_us,
+                         uint32_t char_us) {
+  if (len < MIN_FRAME_SIZE || frame[0] != SLAVE_ADDRESS)
+    return false;
+  bool exception = frame[1] == (txn.func_code | ERROR_MASK);
+  if (!exception && (frame[1] != txn.func_code || len != txn.response_len))
+    return false;
+  // A frame that was already on its way when the request went out is a late answer to an
+  // earlier one. One character of slack for when the UART hands bytes over.
+  uint32_t wire_us = (len - 1) * char_us;
+  return static_cast<int32_t>(received_us - txn.sent_us) >= static_cast<int32_t>(wire_us);
+}
+
 size_t get_response_header_size(uint8_t function_code) {
   if (is_error_response(function_code)) {
     // Error response: slave_addr + func + error_code + CRC(2) = 5
@@ -129,14 +231,25 @@ size_t get_response_header_size(uint8_t function_code) {
 }
 
 std::vector<uint16_t> parse_register_values(const uint8_t *data, size_t data_len) {
-  std::vector<uint16_t> values;
   // data_len is the number of data bytes (from byte_count field)
   // Each register is 2 bytes, big-endian
-  for (size_t i = 0; i + 1 < data_len; i += 2) {
-    values.push_back((data[i] << 8) | data[i + 1]);
-  }
+  RegisterValues view(data, data_len);
+  std::vector<uint16_t> values;
+  values.reserve(view.size());
+  for (size_t i = 0; i < view.size(); i++)
+    values.push_back(view[i]);
   return values;
 }
 
+RegisterValues parse_read_response(const uint8_t *frame, size_t len) {
+  // slave + func + byte_count + data + CRC(2)
+  if (len < 5)
+    return {};
+  size_t byte_count = frame[2];
+  if (3 + byte_count + 2 > len)
+    return {};
+  return RegisterValues(frame + 3, byte_count);
+}
+
 }  // namespace waterfurnace
 }  // namespace esphome
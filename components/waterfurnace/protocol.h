@@ -24,9 +24,36 @@ static constexpr size_t MAX_REGISTERS_PER_REQUEST = 100;
 static constexpr size_t MIN_FRAME_SIZE = 4;            // slave + func + 2 CRC bytes minimum
 static constexpr size_t MAX_FRAME_SIZE = 256;
 
-/// Calculate ModBus CRC16 using polynomial 0xA001
+static constexpr uint16_t CRC16_INIT = 0xFFFF;
+static constexpr uint16_t CRC16_POLY = 0xA001;
+
+/// Calculate ModBus CRC16 using polynomial 0xA001 (slice-by-4 tables)
 uint16_t crc16(const uint8_t *data, size_t len);
 
+/// Continue a CRC16 over more bytes; start from CRC16_INIT.
+/// crc16_update(crc16_update(CRC16_INIT, a, n), b, m) == crc16 over a followed by b.
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+
+// CRC16 variants, all bit-identical to crc16(). Kept for reference and benchmarking.
+uint16_t crc16_bitwise(const uint8_t *data, size_t len);  // Bit at a time, no table
+uint16_t crc16_table(const uint8_t *data, size_t len);    // One 256-entry table, a byte per step
+uint16_t crc16_slice4(const uint8_t *data, size_t len);   // Four tables, four bytes per step
+
+/// CRC16 usable in constant expressions, e.g. to stamp a fixed request at compile time:
+///   static constexpr uint8_t REQ[] = {SLAVE_ADDRESS, FUNC_READ_RANGES, 0x00, 0x58, 0x00, 0x04};
+///   static_assert(crc16_constexpr(REQ, sizeof(REQ)) == 0xD5BD, "");
+constexpr uint16_t crc16_constexpr(const uint8_t *data, size_t len, uint16_t crc = CRC16_INIT) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int j = 0; j < 8; j++)
+      crc = (crc & 0x0001) ? (crc >> 1) ^ CRC16_POLY : crc >> 1;
+  }
+  return crc;
+}
+
+// The vector builders return a vector of exactly the frame's length, whatever its size:
+// keeping frames within MAX_FRAME_SIZE is up to the caller (see paginate_read()).
+
 /// Build a function 65 request: read multiple register ranges
 /// Each pair is (start_address, quantity)
 /// Returns complete RTU frame with CRC
@@ -48,6 +75,17 @@ std::vector<uint8_t> build_write_registers_request(
 /// Returns complete RTU frame with CRC
 std::vector<uint8_t> build_write_single_request(uint16_t address, uint16_t value);
 
+// Allocation-free variants of the builders above. They serialize the same bytes into a
+// caller-provided buffer of `capacity` bytes (MAX_FRAME_SIZE is always enough for a valid
+// request) and return the frame length including CRC, or 0 if the frame does not fit.
+
+size_t build_read_ranges_request(const std::vector<std::pair<uint16_t, uint16_t>> &ranges, uint8_t *frame,
+                                 size_t capacity);
+size_t build_read_registers_request(const std::vector<uint16_t> &addresses, uint8_t *frame, size_t capacity);
+size_t build_write_registers_request(const std::vector<std::pair<uint16_t, uint16_t>> &writes, uint8_t *frame,
+                                     size_t capacity);
+size_t build_write_single_request(uint16_t address, uint16_t value, uint8_t *frame, size_t capacity);
+
 /// Validate a received frame's CRC
 /// Returns true if CRC is valid
 bool validate_frame_crc(const uint8_t *data, size_t len);
@@ -55,6 +93,21 @@ bool validate_frame_crc(const uint8_t *data, size_t len);
 /// Check if a response indicates an error (function code has bit 7 set)
 bool is_error_response(uint8_t function_code);
 
+/// The request in flight. Responses carry no addresses, so a frame is only taken as the
+/// answer to a request if it has the request's function code and the expected length, or is
+/// an exception for that function code, and could have crossed the wire since the request.
+struct Transaction {
+  uint32_t id{0};          // Increments with every request sent
+  uint8_t func_code{0};    // Function code of the request
+  size_t response_len{0};  // Length of a successful response frame
+  uint32_t sent_us{0};     // When the request finished transmitting
+};
+
+/// True if a frame received (complete) at received_us answers the transaction.
+/// char_us is the time one character takes on the wire.
+bool answers_transaction(const Transaction &txn, const uint8_t *frame, size_t len, uint32_t received_us,
+                         uint32_t char_us);
+
 /// Get the expected minimum response size for a given function code
 /// For variable-length responses (func 65/66), returns the header size before byte count
 size_t get_response_header_size(uint8_t function_code);
@@ -64,5 +117,26 @@ size_t get_response_header_size(uint8_t function_code);
 /// Returns vector of uint16_t values in order
 std::vector<uint16_t> parse_register_values(const uint8_t *data, size_t data_len);
 
+/// Register values of a function 65/66 response, decoded in place from the received bytes.
+/// Does not copy: the view is only valid while the frame it points into is.
+class RegisterValues {
+ public:
+  RegisterValues() = default;
+  /// data_len is the number of data bytes; an odd trailing byte is ignored
+  RegisterValues(const uint8_t *data, size_t data_len) : data_(data), size_(data_len / 2) {}
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  uint16_t operator[](size_t index) const { return (data_[index * 2] << 8) | data_[index * 2 + 1]; }
+
+ protected:
+  const uint8_t *data_{nullptr};
+  size_t size_{0};
+};
+
+/// View over the values of a complete function 65/66 response frame
+/// (slave + func + byte_count + data + CRC). Empty if the frame is truncated.
+RegisterValues parse_read_response(const uint8_t *frame, size_t len);
+
 }  // namespace waterfurnace
 }  // namespace esphome
@@ -0,0 +1,57 @@
+#include "range_bisector.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace waterfurnace {
+
+void RangeBisector::start(const std::vector<uint16_t> &addresses) {
+  this->clear();
+  std::vector<uint16_t> sorted = addresses;
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  // The whole set is already known to be rejected
+  this->split_(std::move(sorted));
+}
+
+void RangeBisector::clear() {
+  this->pending_.clear();
+  this->found_.clear();
+  this->probes_ = 0;
+}
+
+RegisterRanges RangeBisector::probe() const {
+  RegisterRanges ranges;
+  if (this->pending_.empty())
+    return ranges;
+  for (uint16_t addr : this->pending_.back())
+    ranges.push_back({addr, 1});
+  return normalize_ranges(ranges);
+}
+
+void RangeBisector::report(bool accepted) {
+  if (this->pending_.empty())
+    return;
+  std::vector<uint16_t> addresses = std::move(this->pending_.back());
+  this->pending_.pop_back();
+  this->probes_++;
+  if (!accepted)
+    this->split_(std::move(addresses));
+}
+
+void RangeBisector::split_(std::vector<uint16_t> addresses) {
+  if (addresses.empty())
+    return;
+  if (addresses.size() == 1) {
+    this->found_.push_back(addresses[0]);
+    return;
+  }
+  size_t half = addresses.size() / 2;
+  // Upper half first so the lower one is probed next
+  this->pending_.emplace_back(addresses.begin() + half, addresses.end());
+  addresses.resize(half);
+  this->pending_.push_back(std::move(addresses));
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "poll_planner.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace esphome {
+namespace waterfurnace {
+
+/// Finds the registers the controller rejects a read for.
+/// An unsupported address makes the whole func 65/66 request fail with an exception, so the
+/// failing group's addresses are halved and each half read on its own; halves that are
+/// rejected are halved again until a rejected probe is down to a single address.
+class RangeBisector {
+ public:
+  /// Start over on the addresses of a rejected request
+  void start(const std::vector<uint16_t> &addresses);
+  void clear();
+
+  /// True while probes remain
+  bool active() const { return !this->pending_.empty(); }
+
+  /// Ranges to read for the current probe; stays the same until report()
+  RegisterRanges probe() const;
+  /// Outcome of the current probe: accepted, or rejected with an exception response
+  void report(bool accepted);
+
+  /// Addresses found to be rejected on their own, in the order found
+  const std::vector<uint16_t> &found() const { return this->found_; }
+  /// Probes answered so far
+  size_t probes() const { return this->probes_; }
+
+ protected:
+  // Split a rejected set into halves to probe, or record it if it is a single address
+  void split_(std::vector<uint16_t> addresses);
+
+  std::vector<std::vector<uint16_t>> pending_;  // Next probe at the back
+  std::vector<uint16_t> found_;
+  size_t probes_{0};
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,73 @@
+#include "register_cache.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace waterfurnace {
+
+void RegisterCache::assign(const std::vector<uint16_t> &addresses) {
+  std::vector<uint16_t> sorted = addresses;
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  if (sorted.size() >= NO_SLOT)
+    sorted.resize(NO_SLOT - 1);
+
+  std::vector<Entry> entries(sorted.size());
+  for (size_t i = 0; i < sorted.size(); i++) {
+    uint16_t slot = this->find(sorted[i]);
+    if (slot != NO_SLOT)
+      entries[i] = this->entries_[slot];
+  }
+  this->addresses_ = std::move(sorted);
+  this->entries_ = std::move(entries);
+}
+
+uint16_t RegisterCache::find(uint16_t address) const {
+  auto it = std::lower_bound(this->addresses_.begin(), this->addresses_.end(), address);
+  if (it == this->addresses_.end() || *it != address)
+    return NO_SLOT;
+  return static_cast<uint16_t>(it - this->addresses_.begin());
+}
+
+std::vector<uint16_t> RegisterCache::resolve(const std::vector<uint16_t> &addresses) const {
+  std::vector<uint16_t> slots;
+  slots.reserve(addresses.size());
+  for (uint16_t address : addresses)
+    slots.push_back(this->find(address));
+  return slots;
+}
+
+bool RegisterCache::changed(uint16_t slot, uint8_t count) const {
+  uint16_t address = this->addresses_[slot];
+  for (uint8_t i = 0; i < count; i++) {
+    size_t s = slot + i;
+    if (s >= this->entries_.size() || this->addresses_[s] != address + i)
+      break;
+    if (this->entries_[s].changed)
+      return true;
+  }
+  return false;
+}
+
+bool RegisterCache::words(uint16_t slot, uint8_t count, uint32_t &value) const {
+  uint16_t address = this->addresses_[slot];
+  value = 0;
+  for (uint8_t i = 0; i < count && i < 2; i++) {
+    size_t s = slot + i;
+    if (s >= this->entries_.size() || this->addresses_[s] != address + i || !this->entries_[s].valid)
+      return false;
+    value = (value << 16) | this->entries_[s].value;
+  }
+  return true;
+}
+
+bool RegisterCache::get(uint16_t address, uint16_t &value) const {
+  uint16_t slot = this->find(address);
+  if (slot == NO_SLOT || !this->entries_[slot].valid)
+    return false;
+  value = this->entries_[slot].value;
+  return true;
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
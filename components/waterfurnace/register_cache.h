@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace esphome {
+namespace waterfurnace {
+
+/// Flat register cache.
+/// Slots are assigned once when the poll plan is built: values live in one contiguous array
+/// indexed by slot, next to a sorted address index. Responses are stored by slot with no
+/// allocation or search; lookups by address are a binary search over the index.
+class RegisterCache {
+ public:
+  static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+  /// Give every address a slot (duplicates and order don't matter). Values already cached for
+  /// addresses that keep a slot are carried over; the others are dropped.
+  void assign(const std::vector<uint16_t> &addresses);
+
+  /// Slot of an address, or NO_SLOT if it is not cached
+  uint16_t find(uint16_t address) const;
+
+  /// Slot for every address, in the same order (NO_SLOT where not cached)
+  std::vector<uint16_t> resolve(const std::vector<uint16_t> &addresses) const;
+
+  size_t size() const { return this->addresses_.size(); }
+  bool contains(uint16_t address) const { return this->find(address) != NO_SLOT; }
+
+  /// Store a received value. Marks the slot changed if it was never set or the value differs;
+  /// a change stays marked until clear_changed(), even if the same value is stored again
+  /// before it is dispatched.
+  void store(uint16_t slot, uint16_t value) {
+    auto &entry = this->entries_[slot];
+    entry.changed = entry.changed || !entry.valid || entry.value != value;
+    entry.value = value;
+    entry.valid = true;
+  }
+  void clear_changed(uint16_t slot) { this->entries_[slot].changed = false; }
+  /// Have the next dispatch of slot treat it as changed, whatever value comes in
+  void mark_changed(uint16_t slot) { this->entries_[slot].changed = true; }
+
+  /// True if any of the count registers starting at slot's address changed.
+  /// Consecutive addresses sit in consecutive slots, so this never searches.
+  bool changed(uint16_t slot, uint8_t count = 1) const;
+
+  /// The count (1 or 2) registers starting at slot's address as one value, first register in
+  /// the high word. False unless every one of them holds a value.
+  bool words(uint16_t slot, uint8_t count, uint32_t &value) const;
+
+  uint16_t value(uint16_t slot) const { return this->entries_[slot].value; }
+  bool valid(uint16_t slot) const { return this->entries_[slot].valid; }
+
+  /// Time of the last dispatch of this slot (for the force publish heartbeat)
+  uint32_t last_dispatch(uint16_t slot) const { return this->entries_[slot].last_dispatch; }
+  void set_last_dispatch(uint16_t slot, uint32_t now) { this->entries_[slot].last_dispatch = now; }
+
+  /// Cached value of an address, false if it is not cached or was never received
+  bool get(uint16_t address, uint16_t &value) const;
+
+ protected:
+  struct Entry {
+    uint16_t value{0};
+    bool valid{false};
+    bool changed{false};        // Set from a change until it has been dispatched
+    uint32_t last_dispatch{0};
+  };
+
+  std::vector<uint16_t> addresses_;  // Sorted, parallel to entries_
+  std::vector<Entry> entries_;
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -201,6 +201,7 @@ static constexpr uint16_t REG_IZ2_ZONE_CONFIG3_BASE = 31200;
 
 // Write registers: base + (zone-1)*9
 static constexpr uint16_t REG_IZ2_WRITE_BASE = 21202;
+static constexpr uint8_t IZ2_MAX_ZONES = 6;
 // Per zone: +0 = mode, +1 = heating SP, +2 = cooling SP, +3 = fan mode,
 //           +4 = fan on time, +5 = fan off time
 
@@ -272,6 +273,13 @@ inline const char *fault_code_to_string(uint8_t code) {
   return "Unknown Fault";
 }
 
+// --- Read breakpoints ---
+// A function 65 range is never allowed to span one of these addresses. The thermostat
+// config registers (12005/12006) sit below the 12100 breakpoint and are read on their
+// own via function 66.
+static constexpr uint16_t READ_BREAKPOINTS[] = {12100};
+static constexpr size_t READ_BREAKPOINTS_SIZE = sizeof(READ_BREAKPOINTS) / sizeof(READ_BREAKPOINTS[0]);
+
 // --- Polling register groups ---
 
 // Group 0: System ID (read once at setup)
@@ -0,0 +1,41 @@
+#include "rtt_tracker.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace waterfurnace {
+
+void RttTracker::add(uint32_t sample_us) {
+  this->samples_[this->next_] = sample_us;
+  this->next_ = (this->next_ + 1) % WINDOW;
+  if (this->count_ < WINDOW)
+    this->count_++;
+}
+
+uint32_t RttTracker::percentile(uint8_t pct) const {
+  if (this->count_ == 0)
+    return 0;
+  // Window is small; select on a copy so the ring keeps its order
+  std::array<uint32_t, WINDOW> sorted = this->samples_;
+  size_t rank = (std::min<size_t>(pct, 100) * this->count_ + 99) / 100;
+  size_t index = rank > 0 ? rank - 1 : 0;
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + this->count_);
+  return sorted[index];
+}
+
+uint32_t RttTracker::limit_us(uint32_t floor_us, uint32_t ceiling_us) const {
+  if (this->count_ < MIN_SAMPLES)
+    return ceiling_us;
+  uint64_t limit = static_cast<uint64_t>(this->percentile(95)) * HEADROOM + SLACK_US;
+  return static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(limit, floor_us), ceiling_us));
+}
+
+uint32_t backoff_delay(uint8_t failures, uint32_t base, uint32_t cap) {
+  uint64_t delay = base;
+  for (uint8_t i = 1; i < failures && delay < cap; i++)
+    delay *= 2;
+  return static_cast<uint32_t>(std::min<uint64_t>(delay, cap));
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome {
+namespace waterfurnace {
+
+/// Response turnaround statistics over a sliding window of recent transactions.
+/// A sample is the time from the end of a request to the end of its response, less the
+/// response's own time on the wire, so groups of every size feed the same distribution and
+/// each request's timeout is its expected wire time plus limit_us().
+class RttTracker {
+ public:
+  static constexpr size_t WINDOW = 32;
+  /// Samples needed before limit_us() trusts the distribution
+  static constexpr size_t MIN_SAMPLES = 8;
+  /// limit = HEADROOM x p95 + SLACK_US. The slack covers loop() cadence and idle framing.
+  static constexpr uint32_t HEADROOM = 3;
+  static constexpr uint32_t SLACK_US = 50000;
+
+  void add(uint32_t sample_us);
+  void clear() { this->count_ = this->next_ = 0; }
+  size_t count() const { return this->count_; }
+
+  /// Nearest-rank percentile (0-100) of the window, 0 if empty
+  uint32_t percentile(uint8_t pct) const;
+
+  /// Turnaround to allow before giving up on a response: ceiling_us until MIN_SAMPLES are in,
+  /// then derived from the 95th percentile and clamped to [floor_us, ceiling_us]
+  uint32_t limit_us(uint32_t floor_us, uint32_t ceiling_us) const;
+
+ protected:
+  std::array<uint32_t, WINDOW> samples_{};
+  size_t next_{0};
+  size_t count_{0};
+};
+
+/// Backoff after the given number of consecutive failures (1 = first): base, doubled for each
+/// further failure, capped
+uint32_t backoff_delay(uint8_t failures, uint32_t base, uint32_t cap);
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -3,13 +3,18 @@ import esphome.config_validation as cv
 from esphome.components import sensor
 from esphome.const import (
     CONF_ID,
+    CONF_UPDATE_INTERVAL,
     DEVICE_CLASS_TEMPERATURE,
     DEVICE_CLASS_PRESSURE,
     DEVICE_CLASS_POWER,
     DEVICE_CLASS_VOLTAGE,
     DEVICE_CLASS_CURRENT,
     DEVICE_CLASS_HUMIDITY,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
     UNIT_WATT,
     UNIT_VOLT,
     UNIT_AMPERE,
@@ -22,11 +27,13 @@ DEPENDENCIES = ["waterfurnace"]
 WaterFurnaceSensor = waterfurnace_ns.class_(
     "WaterFurnaceSensor", sensor.Sensor, cg.Component
 )
+Diagnostic = waterfurnace_ns.enum("Diagnostic", is_class=True)
 
 UNIT_PSI = "psi"
 UNIT_GPM = "gpm"
 UNIT_BTU_H = "BTU/h"
 UNIT_FAHRENHEIT = "°F"
+UNIT_BYTES = "B"
 
 # Sensor configuration keys
 CONF_ENTERING_WATER_TEMPERATURE = "entering_water_temperature"
@@ -58,6 +65,18 @@ CONF_FP2_TEMPERATURE = "fp2_temperature"
 CONF_SUBCOOLING = "subcooling"
 CONF_SUPERHEAT = "superheat"
 
+# Hub diagnostics
+CONF_POLL_INTERVAL = "poll_interval"
+CONF_RX_SKIPPED_BYTES = "rx_skipped_bytes"
+CONF_RX_LENGTH_FRAMES = "rx_length_frames"
+CONF_RX_IDLE_FRAMES = "rx_idle_frames"
+CONF_RX_STALE_RESPONSES = "rx_stale_responses"
+CONF_TURNAROUND_P50 = "turnaround_p50"
+CONF_TURNAROUND_P95 = "turnaround_p95"
+CONF_TURNAROUND_LIMIT = "turnaround_limit"
+CONF_STARTUP_TIME = "startup_time"
+CONF_WRITE_LATENCY = "write_latency"
+
 # Register address, register type, is_32bit
 # register_type: "signed_tenths", "tenths", "unsigned", "uint32", "int32"
 SENSOR_TYPES = {
@@ -258,15 +277,98 @@ SENSOR_DEFAULTS = {
     ),
 }
 
+# Hub diagnostics: key -> Diagnostic enum value
+DIAGNOSTIC_TYPES = {
+    CONF_POLL_INTERVAL: Diagnostic.POLL_INTERVAL,
+    CONF_RX_SKIPPED_BYTES: Diagnostic.RX_SKIPPED_BYTES,
+    CONF_RX_LENGTH_FRAMES: Diagnostic.RX_LENGTH_FRAMES,
+    CONF_RX_IDLE_FRAMES: Diagnostic.RX_IDLE_FRAMES,
+    CONF_RX_STALE_RESPONSES: Diagnostic.RX_STALE_RESPONSES,
+    CONF_TURNAROUND_P50: Diagnostic.TURNAROUND_P50,
+    CONF_TURNAROUND_P95: Diagnostic.TURNAROUND_P95,
+    CONF_TURNAROUND_LIMIT: Diagnostic.TURNAROUND_LIMIT,
+    CONF_STARTUP_TIME: Diagnostic.STARTUP_TIME,
+    CONF_WRITE_LATENCY: Diagnostic.WRITE_LATENCY,
+}
+
+DIAGNOSTIC_DEFAULTS = {
+    CONF_POLL_INTERVAL: sensor.sensor_schema(
+        unit_of_measurement=UNIT_SECOND,
+        accuracy_decimals=0,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_RX_SKIPPED_BYTES: sensor.sensor_schema(
+        unit_of_measurement=UNIT_BYTES,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_RX_LENGTH_FRAMES: sensor.sensor_schema(
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_RX_IDLE_FRAMES: sensor.sensor_schema(
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_RX_STALE_RESPONSES: sensor.sensor_schema(
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_TURNAROUND_P50: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        accuracy_decimals=1,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_TURNAROUND_P95: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        accuracy_decimals=1,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_TURNAROUND_LIMIT: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        accuracy_decimals=1,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_STARTUP_TIME: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        accuracy_decimals=0,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    CONF_WRITE_LATENCY: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+}
+
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(CONF_WATERFURNACE_ID): cv.use_id(WaterFurnace),
         **{
             cv.Optional(key): schema.extend(
-                {cv.GenerateID(): cv.declare_id(WaterFurnaceSensor)}
+                {
+                    cv.GenerateID(): cv.declare_id(WaterFurnaceSensor),
+                    cv.Optional(
+                        CONF_UPDATE_INTERVAL
+                    ): cv.positive_time_period_milliseconds,
+                }
             )
             for key, schema in SENSOR_DEFAULTS.items()
         },
+        **{
+            cv.Optional(key): schema.extend(
+                {cv.GenerateID(): cv.declare_id(WaterFurnaceSensor)}
+            )
+            for key, schema in DIAGNOSTIC_DEFAULTS.items()
+        },
     }
 )
 
@@ -285,3 +387,15 @@ async def to_code(config):
         cg.add(var.set_register_address(register))
         cg.add(var.set_register_type(reg_type))
         cg.add(var.set_is_32bit(is_32bit))
+        if CONF_UPDATE_INTERVAL in conf:
+            cg.add(var.set_update_interval(conf[CONF_UPDATE_INTERVAL]))
+
+    for key, diagnostic in DIAGNOSTIC_TYPES.items():
+        if key not in config:
+            continue
+        conf = config[key]
+        var = cg.new_Pvariable(conf[CONF_ID])
+        await cg.register_component(var, conf)
+        await sensor.register_sensor(var, conf)
+        cg.add(var.set_parent(parent))
+        cg.add(var.set_diagnostic(diagnostic))
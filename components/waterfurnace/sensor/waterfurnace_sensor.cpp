@@ -1,49 +1,50 @@
 #include "waterfurnace_sensor.h"
 #include "esphome/core/log.h"
 
+#include <cinttypes>
+
 namespace esphome {
 namespace waterfurnace {
 
 static const char *const TAG = "waterfurnace.sensor";
 
 void WaterFurnaceSensor::setup() {
-  if (this->is_32bit_) {
-    // 32-bit value: register hi word at address, lo word at address+1
-    this->parent_->register_listener(this->register_address_,
-                                      [this](uint16_t v) { this->on_register_value_hi_(v); });
-    this->parent_->register_listener(this->register_address_ + 1,
-                                      [this](uint16_t v) { this->on_register_value_(v); });
-  } else {
-    this->parent_->register_listener(this->register_address_,
-                                      [this](uint16_t v) { this->on_register_value_(v); });
+  if (this->is_diagnostic_) {
+    this->parent_->register_diagnostic_listener(this->diagnostic_, [this](float v) { this->publish_state(v); });
+    return;
   }
+
+  // 32-bit values watch both words: hi word at address, lo word at address+1
+  this->parent_->register_listener(this->register_address_,
+                                    [this](uint16_t v) { this->on_register_value_(v); },
+                                    this->update_interval_, this->get_force_update(), this->is_32bit_ ? 2 : 1);
 }
 
 void WaterFurnaceSensor::dump_config() {
   ESP_LOGCONFIG(TAG, "WaterFurnace Sensor '%s':", this->get_name().c_str());
+  if (this->is_diagnostic_) {
+    ESP_LOGCONFIG(TAG, "  Hub diagnostic");
+    return;
+  }
   ESP_LOGCONFIG(TAG, "  Register: %u (type: %s, 32bit: %s)",
                 this->register_address_, this->register_type_.c_str(),
                 YESNO(this->is_32bit_));
-}
-
-void WaterFurnaceSensor::on_register_value_hi_(uint16_t value) {
-  this->hi_word_ = value;
-  this->has_hi_word_ = true;
+  if (this->update_interval_ != 0)
+    ESP_LOGCONFIG(TAG, "  Update Interval: %" PRIu32 "ms", this->update_interval_);
 }
 
 void WaterFurnaceSensor::on_register_value_(uint16_t value) {
   float result;
 
   if (this->is_32bit_) {
-    if (!this->has_hi_word_)
+    uint16_t lo;
+    if (!this->parent_->get_register(this->register_address_ + 1, lo))
       return;  // Wait for both words
 
-    if (this->register_type_ == "uint32") {
-      result = static_cast<float>(to_uint32(this->hi_word_, value));
-    } else if (this->register_type_ == "int32") {
-      result = static_cast<float>(to_int32(this->hi_word_, value));
+    if (this->register_type_ == "int32") {
+      result = static_cast<float>(to_int32(value, lo));
     } else {
-      result = static_cast<float>(to_uint32(this->hi_word_, value));
+      result = static_cast<float>(to_uint32(value, lo));
     }
   } else if (this->register_type_ == "signed_tenths") {
     result = static_cast<int16_t>(value) / 10.0f;
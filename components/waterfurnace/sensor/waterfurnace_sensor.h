@@ -19,19 +19,24 @@ class WaterFurnaceSensor : public sensor::Sensor, public Component {
   void set_register_address(uint16_t addr) { register_address_ = addr; }
   void set_register_type(const std::string &type) { register_type_ = type; }
   void set_is_32bit(bool is_32bit) { is_32bit_ = is_32bit; }
+  void set_update_interval(uint32_t update_interval) { update_interval_ = update_interval; }
+  void set_diagnostic(Diagnostic diagnostic) {
+    diagnostic_ = diagnostic;
+    is_diagnostic_ = true;
+  }
 
  protected:
   void on_register_value_(uint16_t value);
-  void on_register_value_hi_(uint16_t value);
 
   WaterFurnace *parent_{nullptr};
   uint16_t register_address_{0};
   std::string register_type_;
   bool is_32bit_{false};
+  uint32_t update_interval_{0};  // 0 = hub update_interval
 
-  // For 32-bit values, cache the high word
-  uint16_t hi_word_{0};
-  bool has_hi_word_{false};
+  // Hub diagnostic instead of a register
+  Diagnostic diagnostic_{};
+  bool is_diagnostic_{false};
 };
 
 }  // namespace waterfurnace
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome {
+namespace waterfurnace {
+
+/// Fixed-size lock-free ring between exactly one producer thread and one consumer thread.
+/// push() is only ever called from the producer and pop() from the consumer; neither blocks,
+/// allocates or takes a lock, so either side may be an ISR-free FreeRTOS task or a std::thread.
+template<typename T, size_t N> class SpscRing {
+ public:
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+  /// Producer: copy item in, false if the ring is full
+  bool push(const T &item) {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head - this->tail_.load(std::memory_order_acquire) == N)
+      return false;
+    this->slots_[head & (N - 1)] = item;
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer: copy the oldest item out, false if the ring is empty
+  bool pop(T &item) {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (this->head_.load(std::memory_order_acquire) == tail)
+      return false;
+    item = this->slots_[tail & (N - 1)];
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Approximate when read from the other side, exact from either side while it is the only one running
+  size_t size() const {
+    return this->head_.load(std::memory_order_acquire) - this->tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return this->size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+ protected:
+  T slots_[N];
+  // Free-running positions, each written by one side only
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
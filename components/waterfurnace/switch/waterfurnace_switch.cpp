@@ -10,6 +10,7 @@ void WaterFurnaceSwitch::setup() {
   this->parent_->register_listener(this->register_address_, [this](uint16_t value) {
     this->publish_state(value != 0);
   });
+  this->parent_->register_readback(this->write_address_, this->register_address_);
 }
 
 void WaterFurnaceSwitch::dump_config() {
@@ -20,7 +21,7 @@ void WaterFurnaceSwitch::dump_config() {
 
 void WaterFurnaceSwitch::write_state(bool state) {
   this->parent_->write_register(this->write_address_, state ? 1 : 0);
-  // Optimistically publish - will be confirmed on next poll
+  // Optimistically publish - confirmed by the read-back right after the write
   this->publish_state(state);
 }
 
@@ -14,12 +14,14 @@ CONF_CURRENT_FAULT = "current_fault"
 CONF_MODEL_NUMBER = "model_number"
 CONF_SERIAL_NUMBER = "serial_number"
 CONF_SYSTEM_MODE = "system_mode"
+CONF_POLLING_MODE = "polling_mode"
 
 TEXT_SENSOR_TYPES = {
     CONF_CURRENT_FAULT: "fault",
     CONF_MODEL_NUMBER: "model",
     CONF_SERIAL_NUMBER: "serial",
     CONF_SYSTEM_MODE: "mode",
+    CONF_POLLING_MODE: "polling_mode",
 }
 
 CONFIG_SCHEMA = cv.Schema(
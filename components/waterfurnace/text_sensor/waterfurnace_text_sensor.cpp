@@ -32,6 +32,11 @@ void WaterFurnaceTextSensor::setup() {
     this->parent_->register_listener(REG_SYSTEM_OUTPUTS, [this](uint16_t v) {
       this->on_system_outputs_(v);
     });
+  } else if (this->sensor_type_ == "polling_mode") {
+    // Adaptive polling mode changes together with the poll interval
+    this->parent_->register_diagnostic_listener(Diagnostic::POLL_INTERVAL, [this](float) {
+      this->publish_state(this->parent_->polling_mode_str());
+    });
   }
 }
 
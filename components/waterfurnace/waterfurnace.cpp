@@ -2,27 +2,96 @@
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
 namespace esphome {
 namespace waterfurnace {
 
 static const char *const TAG = "waterfurnace";
 
+// The hub's UART and DE pin, driven from the bus task
+class UartBusPort : public BusPort {
+ public:
+  UartBusPort(uart::UARTDevice *uart, GPIOPin *flow_control_pin) : uart_(uart), flow_control_pin_(flow_control_pin) {}
+  void write(const uint8_t *data, size_t len) override { this->uart_->write_array(data, len); }
+  size_t read(uint8_t *data, size_t max) override {
+    int available = this->uart_->available();
+    if (available <= 0)
+      return 0;
+    size_t n = std::min(static_cast<size_t>(available), max);
+    return this->uart_->read_array(data, n) ? n : 0;
+  }
+  void set_transmit(bool transmit) override {
+    if (this->flow_control_pin_ != nullptr)
+      this->flow_control_pin_->digital_write(transmit);
+  }
+  uint32_t micros() override { return esphome::micros(); }
+  void yield() override { delay(1); }
+
+ protected:
+  uart::UARTDevice *uart_;
+  GPIOPin *flow_control_pin_;
+};
+
+// Registers read while detecting the system; they stay cached for its lifetime
+static std::vector<uint16_t> setup_addresses() {
+  std::vector<uint16_t> addresses;
+  append_addresses(get_system_id_ranges(), addresses);
+  append_addresses(get_component_detect_ranges(), addresses);
+  return addresses;
+}
+
 void WaterFurnace::setup() {
+  this->setup_time_ = millis();
   if (this->flow_control_pin_ != nullptr) {
     this->flow_control_pin_->setup();
     this->flow_control_pin_->digital_write(false);  // RX mode
   }
-  this->state_ = State::SETUP_READ_ID;
-  this->setup_phase_ = 0;
+  this->state_ = State::SETUP;
+  this->registers_.assign(setup_addresses());
+
+  // Known system from a previous boot: identity is available to entities right away
+  this->setup_cache_pref_ = global_preferences->make_preference<SetupCache>(fnv1_hash("waterfurnace_setup"));
+  this->setup_from_cache_ = this->load_setup_cache_();
+
+  // End-of-frame silence from the UART settings. Bytes are only noticed once per loop() and
+  // drivers hand them over in chunks, so the configured floor normally dominates t3.5.
+  this->bus_timing_.baud_rate = this->parent_->get_baud_rate();
+  this->bus_timing_.bits_per_char = 1 + this->parent_->get_data_bits() + this->parent_->get_stop_bits() +
+                                    (this->parent_->get_parity() != uart::UART_CONFIG_PARITY_NONE ? 1 : 0);
+  this->rx_idle_us_ = std::max(silent_interval_us(this->bus_timing_), this->rx_idle_timeout_);
+
+  if (this->bus_task_) {
+    this->bus_port_ = std::make_unique<UartBusPort>(this, this->flow_control_pin_);
+    this->bus_worker_ = std::make_unique<BusWorker>(this->bus_port_.get(), this->bus_timing_);
+    this->bus_worker_->set_framing(this->rx_.framing(), this->rx_idle_us_);
+    if (!this->bus_worker_->start(BUS_TASK_CORE)) {
+      ESP_LOGW(TAG, "Bus task could not be started, running the bus from the main loop");
+      this->bus_worker_.reset();
+    }
+  }
+
+  if (this->adaptive_polling_) {
+    // Output bitmask and fault register drive the polling rate, so they are always polled
+    this->register_listener(REG_SYSTEM_OUTPUTS, [this](uint16_t) { this->on_equipment_state_(); });
+    this->register_listener(REG_LAST_FAULT, [this](uint16_t) { this->on_equipment_state_(); });
+  }
+
   ESP_LOGI(TAG, "WaterFurnace hub initializing...");
 }
 
 void WaterFurnace::update() {
-  // PollingComponent::update() triggers a new poll cycle
+  // Leave transition mode once the equipment has been stable long enough
+  if (this->polling_mode_ == PollingMode::TRANSITION && millis() - this->last_state_change_ >= this->transition_duration_)
+    this->on_equipment_state_();
+
+  // PollingComponent::update() marks registers at the default rate as due
   // The actual polling happens in loop() via the state machine
-  if (this->state_ == State::IDLE) {
-    this->current_poll_group_ = 0;
-    this->poll_next_group_();
+  for (auto &rate : this->poll_rates_) {
+    if (rate.interval == 0)
+      rate.due = true;
   }
 }
 
@@ -30,26 +99,19 @@ void WaterFurnace::loop() {
   uint32_t now = millis();
 
   switch (this->state_) {
-    case State::SETUP_READ_ID: {
-      if (this->setup_phase_ == 0) {
-        ESP_LOGI(TAG, "Reading system identification...");
-        this->read_system_id_();
-        this->setup_phase_ = 1;
-        this->state_ = State::WAITING_RESPONSE;
-        return;
-      }
-      break;
-    }
-
-    case State::SETUP_DETECT_COMPONENTS: {
-      if (this->setup_phase_ == 0) {
-        ESP_LOGI(TAG, "Detecting installed components...");
-        this->detect_components_();
-        this->setup_phase_ = 1;
-        this->state_ = State::WAITING_RESPONSE;
+    case State::SETUP: {
+      if (this->setup_from_cache_) {
+        // Entities have registered their listeners by now; poll from the cached detection
+        ESP_LOGI(TAG, "Using cached system detection (%s), verifying in the background",
+                 this->model_number_.c_str());
+        this->setup_from_cache_ = false;
+        this->verify_system_id_ = true;
+        this->finish_setup_();
         return;
       }
-      break;
+      ESP_LOGI(TAG, "Reading system identification and installed components...");
+      this->read_setup_registers_();
+      return;
     }
 
     case State::IDLE: {
@@ -58,44 +120,87 @@ void WaterFurnace::loop() {
         this->process_pending_writes_();
         return;
       }
+      if (this->poll_groups_dirty_)
+        this->build_poll_groups_();
+      // Bisection probes run between cycles
+      if (this->bisector_.active()) {
+        this->send_probe_();
+        return;
+      }
+      this->start_poll_cycle_(now);
+      // Check a cached setup once the bus is free
+      if (this->state_ == State::IDLE && this->verify_system_id_)
+        this->read_setup_registers_();
+      break;
+    }
+
+    case State::TRANSMITTING: {
+      // Never wait for the bus here: check back on the next pass until the frame is out
+      if (static_cast<int32_t>(micros() - this->tx_done_us_) >= 0)
+        this->finish_transmit_();
       break;
     }
 
     case State::WAITING_RESPONSE: {
+      if (this->bus_worker_ != nullptr) {
+        this->poll_bus_worker_(now);
+        break;
+      }
+
       // Try to read a complete frame
-      std::vector<uint8_t> frame;
-      if (this->read_frame_(frame)) {
+      size_t len = this->read_frame_();
+      if (len > 0 && !answers_transaction(this->transaction_, this->rx_frame_, len, this->rx_last_byte_us_,
+                                          char_time_us(this->bus_timing_))) {
+        // A late answer to an earlier request: drop it and keep waiting for ours
+        this->stale_responses_++;
+        ESP_LOGW(TAG, "Discarded stale response: func=0x%02X, %u bytes (request #%" PRIu32 " expects 0x%02X, %u bytes)",
+                 this->rx_frame_[1], static_cast<unsigned>(len), this->transaction_.id, this->transaction_.func_code,
+                 static_cast<unsigned>(this->transaction_.response_len));
+        this->publish_diagnostic_(Diagnostic::RX_STALE_RESPONSES, this->stale_responses_);
+        return;
+      }
+      if (len > 0) {
         this->last_response_time_ = now;
-        this->process_response_(frame);
+        this->record_response_(micros());
+        this->process_response_(this->rx_frame_, len);
+        return;
+      }
+
+      // The line went quiet on something that is not a response; no point waiting it out
+      if (this->rx_.malformed_frames() != this->rx_malformed_frames_) {
+        this->rx_malformed_frames_ = this->rx_.malformed_frames();
+        ESP_LOGW(TAG, "Malformed response (line idle after %ums)", static_cast<unsigned>(now - this->last_request_time_));
+        this->fail_request_(now);
         return;
       }
 
       // Check for timeout
-      if (now - this->last_request_time_ > RESPONSE_TIMEOUT) {
-        ESP_LOGW(TAG, "Response timeout (waited %ums)", RESPONSE_TIMEOUT);
-        this->rx_buffer_.clear();
-        this->error_backoff_until_ = now + ERROR_BACKOFF_TIME;
-        this->state_ = State::ERROR_BACKOFF;
+      if (now - this->last_request_time_ > this->response_timeout_) {
+        ESP_LOGW(TAG, "Response timeout (waited %" PRIu32 "ms)", this->response_timeout_);
+        this->fail_request_(now);
       }
       break;
     }
 
     case State::ERROR_BACKOFF: {
-      if (now >= this->error_backoff_until_) {
-        ESP_LOGI(TAG, "Error backoff complete, resuming");
+      // The failed request has had its retry by now; a write someone is waiting on goes out
+      // instead of sitting out a backoff of up to a minute
+      bool write_waiting = this->setup_complete_ && !this->pending_writes_.empty();
+      if (now >= this->error_backoff_until_ || write_waiting) {
+        if (now >= this->error_backoff_until_) {
+          ESP_LOGI(TAG, "Error backoff complete, resuming");
+        } else {
+          ESP_LOGI(TAG, "Write pending, ending error backoff %" PRIu32 "ms early", this->error_backoff_until_ - now);
+        }
         // If we were in setup, retry
-        if (this->setup_phase_ != 0) {
-          this->setup_phase_ = 0;
-          // Determine which setup state to return to
-          if (this->model_number_.empty()) {
-            this->state_ = State::SETUP_READ_ID;
-          } else if (!this->has_thermostat_ && !this->has_axb_) {
-            this->state_ = State::SETUP_DETECT_COMPONENTS;
-          } else {
-            this->state_ = State::IDLE;
-          }
+        if (!this->setup_complete_) {
+          this->state_ = State::SETUP;
+        } else if (this->cycle_in_progress_() && this->active_group_ == &this->cycle_group_()) {
+          // Pick the interrupted cycle up after the group that failed
+          this->advance_cycle_();
         } else {
-          this->state_ = State::IDLE;
+          // A failed write may have cut into a cycle too
+          this->resume_cycle_();
         }
       }
       break;
@@ -119,160 +224,379 @@ void WaterFurnace::dump_config() {
   if (this->flow_control_pin_ != nullptr) {
     LOG_PIN("  Flow Control Pin: ", this->flow_control_pin_);
   }
-  ESP_LOGCONFIG(TAG, "  Poll groups: %d", this->poll_groups_.size());
-  ESP_LOGCONFIG(TAG, "  Registered listeners: %d", this->listeners_.size());
+  if (this->adaptive_polling_) {
+    ESP_LOGCONFIG(TAG, "  Adaptive polling: idle %" PRIu32 "ms, running %" PRIu32 "ms, transition %" PRIu32
+                       "ms for %" PRIu32 "ms",
+                  this->idle_interval_, this->running_interval_, this->transition_interval_,
+                  this->transition_duration_);
+    ESP_LOGCONFIG(TAG, "  Polling mode: %s (%" PRIu32 "ms)", this->polling_mode_str(), this->get_update_interval());
+  }
+  ESP_LOGCONFIG(TAG, "  Polled registers: %u of %u available", static_cast<unsigned>(this->polled_register_count_),
+                static_cast<unsigned>(this->available_register_count_));
+  for (const auto &rate : this->poll_rates_) {
+    size_t registers = count_registers(rate.ranges) + rate.individual.size();
+    if (rate.interval == 0) {
+      ESP_LOGCONFIG(TAG, "  Poll rate: update_interval, %u registers", static_cast<unsigned>(registers));
+    } else {
+      ESP_LOGCONFIG(TAG, "  Poll rate: %ums, %u registers", static_cast<unsigned>(rate.interval),
+                    static_cast<unsigned>(registers));
+    }
+  }
+  // Worst case: every rate due on the same tick, merged into one cycle
+  RegisterRanges all_ranges;
+  for (const auto &rate : this->poll_rates_)
+    all_ranges.insert(all_ranges.end(), rate.ranges.begin(), rate.ranges.end());
+  auto full_plan = plan_read_ranges(all_ranges, this->bus_timing_, this->excluded_registers_, this->pairs_);
+  ESP_LOGCONFIG(TAG, "  Full cycle: %u func 65 requests (~%u us on the bus)", static_cast<unsigned>(full_plan.size()),
+                static_cast<unsigned>(estimate_plan_us(full_plan, this->bus_timing_)));
+  static const char *const FRAMING[] = {"length", "idle", "auto"};
+  ESP_LOGCONFIG(TAG, "  Framing: %s (idle after %" PRIu32 "us)", FRAMING[static_cast<uint8_t>(this->rx_.framing())],
+                this->rx_idle_us_);
+  ESP_LOGCONFIG(TAG, "  Bus I/O: %s", this->bus_worker_ != nullptr ? "dedicated task" : "main loop");
+  if (!this->excluded_registers_.empty()) {
+    std::string excluded;
+    for (uint16_t addr : this->excluded_registers_)
+      excluded += (excluded.empty() ? "" : ", ") + std::to_string(addr);
+    ESP_LOGCONFIG(TAG, "  Excluded registers (rejected by the controller): %s", excluded.c_str());
+  }
+  for (const auto &plan : this->cycle_plans_) {
+    for (const auto &group : plan.groups) {
+      if (group.failures > 0) {
+        ESP_LOGCONFIG(TAG, "  Poll group of %u registers from %u: %" PRIu32 " failures%s",
+                      static_cast<unsigned>(group.addresses.size()),
+                      static_cast<unsigned>(group.addresses.empty() ? 0 : group.addresses.front()), group.failures,
+                      group.bisected ? " (bisected)" : "");
+      }
+    }
+  }
+  ESP_LOGCONFIG(TAG, "  Register cache: %u slots", static_cast<unsigned>(this->registers_.size()));
+  ESP_LOGCONFIG(TAG, "  Registered listeners: %u", static_cast<unsigned>(this->listeners_.size()));
+  ESP_LOGCONFIG(TAG, "  Force publish interval: %" PRIu32 "ms", this->force_publish_interval_);
+  if (this->first_dispatch_)
+    ESP_LOGCONFIG(TAG, "  Startup time: %" PRIu32 "ms", this->startup_time_);
+  if (this->write_latency_max_ > 0)
+    ESP_LOGCONFIG(TAG, "  Longest write wait: %" PRIu32 "ms", this->write_latency_max_);
+  if (this->pending_writes_.coalesced() > 0)
+    ESP_LOGCONFIG(TAG, "  Coalesced writes: %" PRIu32, this->pending_writes_.coalesced());
+  if (this->stale_responses_ > 0)
+    ESP_LOGCONFIG(TAG, "  Stale responses discarded: %" PRIu32, this->stale_responses_);
+}
+
+void WaterFurnace::register_listener(uint16_t register_addr, std::function<void(uint16_t)> callback,
+                                     uint32_t update_interval, bool dispatch_unchanged, uint8_t count) {
+  this->listeners_.add({register_addr, std::move(callback), update_interval, dispatch_unchanged, count});
+  // A listener added after setup needs its register in the poll set
+  if (this->setup_complete_)
+    this->poll_groups_dirty_ = true;
 }
 
-void WaterFurnace::register_listener(uint16_t register_addr, std::function<void(uint16_t)> callback) {
-  this->listeners_.push_back({register_addr, std::move(callback)});
+void WaterFurnace::register_diagnostic_listener(Diagnostic diagnostic, std::function<void(float)> callback) {
+  this->diagnostic_listeners_.push_back({diagnostic, std::move(callback)});
 }
 
 void WaterFurnace::write_register(uint16_t addr, uint16_t value) {
-  this->pending_writes_.push_back({addr, value});
-  ESP_LOGD(TAG, "Queued write: register %u = %u", addr, value);
+  if (this->pending_writes_.set(addr, value, millis())) {
+    ESP_LOGD(TAG, "Queued write: register %u = %u (replaces unsent value)", addr, value);
+  } else {
+    ESP_LOGD(TAG, "Queued write: register %u = %u", addr, value);
+  }
+}
+
+void WaterFurnace::register_readback(uint16_t write_addr, uint16_t read_addr) {
+  this->readback_registers_.push_back({write_addr, read_addr});
 }
 
 bool WaterFurnace::get_register(uint16_t addr, uint16_t &value) const {
-  auto it = this->registers_.find(addr);
-  if (it != this->registers_.end()) {
-    value = it->second;
-    return true;
-  }
-  return false;
+  return this->registers_.get(addr, value);
 }
 
-void WaterFurnace::send_frame_(const std::vector<uint8_t> &frame) {
+void WaterFurnace::send_frame_(const uint8_t *frame, size_t len, size_t response_len) {
+  this->request_ = frame;
+  this->request_len_ = len;
+  this->transaction_.id++;
+  this->transaction_.func_code = frame[1];
+  this->transaction_.response_len = response_len;
+  this->retried_ = false;
+  // Reads are held to their wire time plus the measured turnaround; writes may take the
+  // controller longer, so they keep the fixed timeout
+  if (this->active_group_ != nullptr) {
+    uint32_t wire_us = response_len * char_time_us(this->bus_timing_);
+    this->response_timeout_ = (wire_us + this->turnaround_limit_us_ + 999) / 1000;
+  } else {
+    this->response_timeout_ = RESPONSE_TIMEOUT;
+  }
+  ESP_LOGV(TAG, "TX frame (%u bytes): %s", static_cast<unsigned>(len), format_hex_pretty(frame, len).c_str());
+
+  if (this->bus_worker_ != nullptr) {
+    // The bus task transmits, times out and matches the response; we only wait for the result
+    BusRequest &request = this->bus_request_;
+    request.id = this->transaction_.id;
+    request.len = static_cast<uint16_t>(len);
+    request.response_len = static_cast<uint16_t>(response_len);
+    request.timeout_us = this->response_timeout_ * 1000;
+    std::memcpy(request.frame, frame, len);
+    if (!this->bus_worker_->submit(request))
+      ESP_LOGW(TAG, "Bus task queue full, request dropped");
+    this->last_request_time_ = millis();
+    this->state_ = State::WAITING_RESPONSE;
+    return;
+  }
+
+  this->discard_input_();
+
   // Assert DE pin for transmit
   if (this->flow_control_pin_ != nullptr) {
     this->flow_control_pin_->digital_write(true);
   }
 
-  this->write_array(frame.data(), frame.size());
-  this->flush();
+  // Queued to the UART without waiting for it to drain; loop() releases the bus once the
+  // frame's wire time (plus a character of margin for the UART to start) has passed.
+  // Timed from before the write: without a TX ring buffer, write_array() only returns once
+  // whatever does not fit the FIFO is in it, and part of the frame is already out by then.
+  this->tx_done_us_ = micros() + (len + 1) * char_time_us(this->bus_timing_);
+  this->write_array(frame, len);
+  this->high_freq_.start();
+  this->state_ = State::TRANSMITTING;
+}
 
+void WaterFurnace::finish_transmit_() {
   // De-assert DE pin for receive
   if (this->flow_control_pin_ != nullptr) {
     this->flow_control_pin_->digital_write(false);
   }
+  this->high_freq_.stop();
 
+  // The response timer starts once the request is out
   this->last_request_time_ = millis();
-  this->rx_buffer_.clear();
+  this->transaction_.sent_us = this->tx_done_us_;
+  this->rx_.reset();
+  this->state_ = State::WAITING_RESPONSE;
+}
 
-  ESP_LOGV(TAG, "TX frame (%d bytes): %s", frame.size(),
-           format_hex_pretty(frame).c_str());
+void WaterFurnace::discard_input_() {
+  // A response that came in after its request timed out is still in the UART buffer
+  size_t stale = this->rx_.buffered();
+  int pending;
+  while ((pending = this->available()) > 0) {
+    size_t n = std::min(static_cast<size_t>(pending), sizeof(this->rx_frame_));
+    if (!this->read_array(this->rx_frame_, n))
+      break;
+    stale += n;
+  }
+  this->rx_.reset();
+  if (stale > 0)
+    ESP_LOGD(TAG, "Discarded %u stale bytes before sending", static_cast<unsigned>(stale));
 }
 
-bool WaterFurnace::read_frame_(std::vector<uint8_t> &frame) {
-  // Read all available bytes into buffer
-  while (this->available()) {
-    uint8_t byte;
-    if (this->read_byte(&byte)) {
-      this->rx_buffer_.push_back(byte);
-    }
+size_t WaterFurnace::read_frame_() {
+  // Drain the UART straight into the receive ring with bulk reads
+  uint32_t now = micros();
+  int pending;
+  while ((pending = this->available()) > 0) {
+    size_t contiguous;
+    uint8_t *dst = this->rx_.write_ptr(contiguous);
+    size_t n = std::min(static_cast<size_t>(pending), contiguous);
+    if (n == 0 || !this->read_array(dst, n))
+      break;
+    this->rx_.commit(n);
+    this->rx_last_byte_us_ = now;
   }
 
-  // Need at least: slave_addr + func_code + something
-  if (this->rx_buffer_.size() < 3)
-    return false;
+  // Only the new bytes are looked at
+  size_t len = this->rx_.poll(this->rx_frame_);
 
-  uint8_t func_code = this->rx_buffer_[1];
+  // Idle framing: whatever arrived before the line went quiet is the frame
+  if (len == 0 && this->rx_.buffered() > 0 && now - this->rx_last_byte_us_ >= this->rx_idle_us_)
+    len = this->rx_.close(this->rx_frame_);
 
-  // Error response: 5 bytes total
-  if (is_error_response(func_code)) {
-    if (this->rx_buffer_.size() >= 5) {
-      frame.assign(this->rx_buffer_.begin(), this->rx_buffer_.begin() + 5);
-      this->rx_buffer_.erase(this->rx_buffer_.begin(), this->rx_buffer_.begin() + 5);
-      return validate_frame_crc(frame.data(), frame.size());
-    }
-    return false;
+  if (this->rx_.crc_errors() != this->rx_crc_errors_) {
+    this->rx_crc_errors_ = this->rx_.crc_errors();
+    ESP_LOGW(TAG, "CRC validation failed");
+  }
+  if (this->rx_.skipped_bytes() != this->rx_skipped_bytes_) {
+    ESP_LOGD(TAG, "Resynchronized receive stream, skipped %u bytes",
+             static_cast<unsigned>(this->rx_.skipped_bytes() - this->rx_skipped_bytes_));
+    this->rx_skipped_bytes_ = this->rx_.skipped_bytes();
+    this->publish_diagnostic_(Diagnostic::RX_SKIPPED_BYTES, this->rx_skipped_bytes_);
   }
+  if (len > 0) {
+    ESP_LOGV(TAG, "RX frame (%u bytes): %s", static_cast<unsigned>(len),
+             format_hex_pretty(this->rx_frame_, len).c_str());
+  }
+  return len;
+}
 
-  size_t expected_size;
+void WaterFurnace::record_response_(uint32_t received_us) {
+  this->consecutive_failures_ = 0;
+  if (this->active_group_ == nullptr)
+    return;
+  uint32_t rtt_us = received_us - this->transaction_.sent_us;
+  uint32_t wire_us = this->transaction_.response_len * char_time_us(this->bus_timing_);
+  this->turnaround_.add(rtt_us > wire_us ? rtt_us - wire_us : 0);
+  this->turnaround_limit_us_ = this->turnaround_.limit_us(MIN_RESPONSE_TIMEOUT * 1000, RESPONSE_TIMEOUT * 1000);
+}
 
-  switch (func_code) {
-    case FUNC_READ_RANGES:
-    case FUNC_READ_REGISTERS: {
-      // Variable length: slave + func + byte_count + data[byte_count] + CRC(2)
-      if (this->rx_buffer_.size() < 3)
-        return false;
-      uint8_t byte_count = this->rx_buffer_[2];
-      expected_size = 3 + byte_count + 2;  // header + data + CRC
-      break;
+void WaterFurnace::poll_bus_worker_(uint32_t now) {
+  BusResult &result = this->bus_result_;
+  if (!this->bus_worker_->poll(result)) {
+    // The task times out on its own; this only catches a request it never got
+    if (now - this->last_request_time_ > this->response_timeout_ + BUS_TASK_GRACE) {
+      ESP_LOGW(TAG, "No result from bus task for request #%" PRIu32, this->transaction_.id);
+      this->fail_request_(now);
     }
-    case FUNC_WRITE_REGISTERS:
-      // Minimal echo response: slave + func + CRC(2) = 4
-      expected_size = 4;
+    return;
+  }
+  if (result.id != this->transaction_.id)
+    return;
+
+  // Receive statistics are kept by the task
+  this->rx_length_frames_ = result.length_frames;
+  this->rx_idle_frames_ = result.idle_frames;
+  if (result.skipped_bytes != this->rx_skipped_bytes_) {
+    ESP_LOGD(TAG, "Resynchronized receive stream, skipped %u bytes",
+             static_cast<unsigned>(result.skipped_bytes - this->rx_skipped_bytes_));
+    this->rx_skipped_bytes_ = result.skipped_bytes;
+    this->publish_diagnostic_(Diagnostic::RX_SKIPPED_BYTES, this->rx_skipped_bytes_);
+  }
+  if (result.stale_responses != this->stale_responses_) {
+    ESP_LOGW(TAG, "Discarded %u stale responses", static_cast<unsigned>(result.stale_responses - this->stale_responses_));
+    this->stale_responses_ = result.stale_responses;
+    this->publish_diagnostic_(Diagnostic::RX_STALE_RESPONSES, this->stale_responses_);
+  }
+
+  switch (result.status) {
+    case BusStatus::RESPONSE:
+      std::memcpy(this->rx_frame_, result.frame, result.len);
+      ESP_LOGV(TAG, "RX frame (%u bytes): %s", static_cast<unsigned>(result.len),
+               format_hex_pretty(this->rx_frame_, result.len).c_str());
+      this->last_response_time_ = now;
+      this->transaction_.sent_us = result.sent_us;
+      this->record_response_(result.received_us);
+      this->process_response_(this->rx_frame_, result.len);
       break;
-    case FUNC_WRITE_SINGLE:
-      // Echo: slave + func + addr(2) + value(2) + CRC(2) = 8
-      expected_size = 8;
+    case BusStatus::MALFORMED:
+      ESP_LOGW(TAG, "Malformed response (line idle after %ums)", static_cast<unsigned>(now - this->last_request_time_));
+      this->fail_request_(now);
       break;
-    default:
-      // Unknown function, try variable length
-      if (this->rx_buffer_.size() < 3)
-        return false;
-      expected_size = 3 + this->rx_buffer_[2] + 2;
+    case BusStatus::TIMEOUT:
+      ESP_LOGW(TAG, "Response timeout (waited %" PRIu32 "ms)", this->response_timeout_);
+      this->fail_request_(now);
       break;
   }
+}
 
-  if (this->rx_buffer_.size() < expected_size)
-    return false;
-
-  frame.assign(this->rx_buffer_.begin(), this->rx_buffer_.begin() + expected_size);
-  this->rx_buffer_.erase(this->rx_buffer_.begin(), this->rx_buffer_.begin() + expected_size);
+void WaterFurnace::fail_request_(uint32_t now) {
+  // A lost response is usually a one-off: ask again right away before backing off
+  if (!this->retried_ && this->request_ != nullptr) {
+    ESP_LOGD(TAG, "Retrying request");
+    this->send_frame_(this->request_, this->request_len_, this->transaction_.response_len);
+    this->retried_ = true;
+    return;
+  }
+  this->enter_backoff_(now);
+}
 
-  ESP_LOGV(TAG, "RX frame (%d bytes): %s", frame.size(),
-           format_hex_pretty(frame).c_str());
+void WaterFurnace::enter_backoff_(uint32_t now) {
+  if (this->active_group_ != nullptr)
+    this->active_group_->failures++;
+  if (this->active_group_ == &this->readback_group_)
+    this->on_readback_failed_();
+  if (this->consecutive_failures_ < UINT8_MAX)
+    this->consecutive_failures_++;
+  uint32_t backoff = backoff_delay(this->consecutive_failures_, ERROR_BACKOFF_MIN, ERROR_BACKOFF_MAX);
+  ESP_LOGD(TAG, "Backing off for %" PRIu32 "ms (%u consecutive failures)", backoff,
+           static_cast<unsigned>(this->consecutive_failures_));
+  this->rx_.reset();
+  this->error_backoff_until_ = now + backoff;
+  this->state_ = State::ERROR_BACKOFF;
+}
 
-  if (!validate_frame_crc(frame.data(), frame.size())) {
-    ESP_LOGW(TAG, "CRC validation failed");
-    return false;
+void WaterFurnace::publish_bus_stats_() {
+  if (this->bus_worker_ == nullptr) {
+    this->rx_length_frames_ = this->rx_.length_frames();
+    this->rx_idle_frames_ = this->rx_.idle_frames();
+  }
+  this->publish_diagnostic_(Diagnostic::RX_LENGTH_FRAMES, this->rx_length_frames_);
+  this->publish_diagnostic_(Diagnostic::RX_IDLE_FRAMES, this->rx_idle_frames_);
+  if (this->turnaround_.count() > 0) {
+    this->publish_diagnostic_(Diagnostic::TURNAROUND_P50, this->turnaround_.percentile(50) / 1000.0f);
+    this->publish_diagnostic_(Diagnostic::TURNAROUND_P95, this->turnaround_.percentile(95) / 1000.0f);
+    this->publish_diagnostic_(Diagnostic::TURNAROUND_LIMIT, this->turnaround_limit_us_ / 1000.0f);
   }
-
-  return true;
 }
 
-void WaterFurnace::process_response_(const std::vector<uint8_t> &frame) {
-  if (frame.size() < MIN_FRAME_SIZE)
+void WaterFurnace::process_response_(const uint8_t *frame, size_t len) {
+  if (len < MIN_FRAME_SIZE)
     return;
 
   uint8_t func_code = frame[1];
 
   // Handle error responses
   if (is_error_response(func_code)) {
-    uint8_t error_code = (frame.size() > 2) ? frame[2] : 0;
+    uint8_t error_code = (len > 2) ? frame[2] : 0;
     ESP_LOGW(TAG, "Error response: func=0x%02X error=0x%02X", func_code, error_code);
 
     // If we're in setup, go to error backoff
-    if (this->state_ == State::WAITING_RESPONSE &&
-        (this->model_number_.empty() || this->poll_groups_.empty())) {
-      this->error_backoff_until_ = millis() + ERROR_BACKOFF_TIME;
-      this->state_ = State::ERROR_BACKOFF;
-    } else {
+    if (this->state_ == State::WAITING_RESPONSE && !this->setup_complete_) {
+      this->enter_backoff_(millis());
+    } else if (this->active_group_ == &this->setup_group_) {
+      // System ID check refused; keep running on the cached setup
+      this->verify_system_id_ = false;
       this->state_ = State::IDLE;
+    } else if (this->active_group_ == &this->probe_group_) {
+      this->on_probe_result_(false);
+    } else if (this->active_group_ == &this->readback_group_) {
+      // Confirmed at the next poll instead
+      this->on_readback_failed_();
+      this->resume_cycle_();
+    } else if (this->active_group_ != nullptr) {
+      // Contained to this group: the rest of the cycle still gets read
+      this->on_group_rejected_(*this->active_group_);
+      this->advance_cycle_();
+    } else {
+      // Rejected write
+      this->resume_cycle_();
     }
     return;
   }
 
   // Handle read responses (func 65/66)
   if (func_code == FUNC_READ_RANGES || func_code == FUNC_READ_REGISTERS) {
-    if (frame.size() < 5)
+    if (len < 5)
       return;
 
-    uint8_t byte_count = frame[2];
-    auto values = parse_register_values(frame.data() + 3, byte_count);
+    // Values are decoded in place from the frame
+    RegisterValues values = parse_read_response(frame, len);
 
     // Map values back to register addresses
-    if (values.size() == this->expected_addresses_.size()) {
+    const PollGroup *group = this->active_group_;
+    const PollGroup::Page *page = nullptr;
+    if (group != nullptr && this->current_page_ < group->pages.size())
+      page = &group->pages[this->current_page_];
+    if (page != nullptr && values.size() == page->addresses.size()) {
+      // Cache the whole response first so listeners spanning several registers (32-bit
+      // values) see every word of this sample: the planner never splits a pair across groups,
+      // and the pages of a group are dispatched together
+      // (bridged gap registers nobody listens to have no slot)
       for (size_t i = 0; i < values.size(); i++) {
-        uint16_t addr = this->expected_addresses_[i];
-        uint16_t val = values[i];
-        this->registers_[addr] = val;
-        this->dispatch_register_(addr, val);
+        if (page->slots[i] != RegisterCache::NO_SLOT)
+          this->registers_.store(page->slots[i], values[i]);
       }
+      // A group split over several requests is dispatched once, with its last page
+      if (++this->current_page_ < group->pages.size()) {
+        this->send_page_();
+        return;
+      }
+      if (group == &this->setup_group_)
+        this->on_setup_read_();
+      this->dispatch_group_(*group);
+      group->consecutive_rejections = 0;
     } else {
-      ESP_LOGW(TAG, "Response value count mismatch: got %d, expected %d",
-               values.size(), this->expected_addresses_.size());
+      ESP_LOGW(TAG, "Response value count mismatch: got %u, expected %u", static_cast<unsigned>(values.size()),
+               static_cast<unsigned>(page != nullptr ? page->addresses.size() : 0));
+      // Nothing was decoded, so the request failed like a lost response would have
+      this->fail_request_(millis());
+      return;
     }
   }
 
@@ -282,274 +606,745 @@ void WaterFurnace::process_response_(const std::vector<uint8_t> &frame) {
   }
 
   // Handle write single response (func 6 echo)
-  if (func_code == FUNC_WRITE_SINGLE && frame.size() >= 6) {
+  if (func_code == FUNC_WRITE_SINGLE && len >= 6) {
     uint16_t addr = (frame[2] << 8) | frame[3];
     uint16_t val = (frame[4] << 8) | frame[5];
     ESP_LOGD(TAG, "Write single acknowledged: reg %u = %u", addr, val);
-    this->registers_[addr] = val;
-    this->dispatch_register_(addr, val);
+    uint16_t slot = this->registers_.find(addr);
+    if (slot != RegisterCache::NO_SLOT) {
+      this->registers_.store(slot, val);
+      this->dispatch_register_(this->listeners_.find(addr), slot, val, millis());
+      this->registers_.clear_changed(slot);
+    }
   }
 
   // State transitions after successful response
   if (this->state_ == State::WAITING_RESPONSE) {
-    if (this->poll_groups_.empty() && this->model_number_.empty()) {
-      // Just received system ID response
-      // Decode system ID from received registers
-      this->abc_program_ = decode_string_(this->registers_, REG_ABC_PROGRAM, 4);
-      this->model_number_ = decode_string_(this->registers_, REG_MODEL_NUMBER, 12);
-      this->serial_number_ = decode_string_(this->registers_, REG_SERIAL_NUMBER, 5);
-
-      // Trim trailing spaces/nulls
-      while (!this->abc_program_.empty() && (this->abc_program_.back() == ' ' || this->abc_program_.back() == '\0'))
-        this->abc_program_.pop_back();
-      while (!this->model_number_.empty() && (this->model_number_.back() == ' ' || this->model_number_.back() == '\0'))
-        this->model_number_.pop_back();
-      while (!this->serial_number_.empty() && (this->serial_number_.back() == ' ' || this->serial_number_.back() == '\0'))
-        this->serial_number_.pop_back();
-
-      ESP_LOGI(TAG, "System ID: program=%s model=%s serial=%s",
-               this->abc_program_.c_str(), this->model_number_.c_str(),
-               this->serial_number_.c_str());
-
-      // Detect VS drive from program name
-      this->has_vs_drive_ = (this->abc_program_ == "ABCVSP" ||
-                              this->abc_program_ == "ABCVSPR" ||
-                              this->abc_program_ == "ABCSPLVS");
-
-      this->state_ = State::SETUP_DETECT_COMPONENTS;
-      this->setup_phase_ = 0;
-    } else if (this->setup_phase_ != 0) {
-      // Just finished component detection
-      // Decode component status from registers
-      auto check_component = [this](uint16_t status_reg) -> bool {
-        auto it = this->registers_.find(status_reg);
-        if (it == this->registers_.end())
-          return false;
-        return it->second != COMPONENT_REMOVED && it->second != COMPONENT_MISSING && it->second != 0;
-      };
-
-      auto get_version = [this](uint16_t version_reg) -> float {
-        auto it = this->registers_.find(version_reg);
-        if (it == this->registers_.end())
-          return 0.0f;
-        return it->second / 100.0f;
-      };
-
-      this->has_thermostat_ = check_component(REG_THERMOSTAT_STATUS);
-      this->has_axb_ = check_component(REG_AXB_STATUS);
-      this->has_iz2_ = check_component(REG_IZ2_STATUS);
-      this->has_aoc_ = check_component(REG_AOC_STATUS);
-      this->has_moc_ = check_component(REG_MOC_STATUS);
-
-      // AWL versions
-      float therm_ver = get_version(REG_THERMOSTAT_VERSION);
-      float axb_ver = get_version(REG_AXB_VERSION);
-      float iz2_ver = get_version(REG_IZ2_VERSION);
-
-      this->awl_thermostat_ = this->has_thermostat_ && therm_ver >= 3.0f;
-      this->awl_axb_ = this->has_axb_ && axb_ver >= 2.0f;
-      this->awl_iz2_ = this->has_iz2_ && iz2_ver >= 2.0f;
-
-      // Energy monitoring available if AXB present
-      this->has_energy_monitoring_ = this->has_axb_;
-
-      // IZ2 zone count
-      if (this->awl_iz2_) {
-        auto it = this->registers_.find(REG_IZ2_ZONE_COUNT);
-        if (it != this->registers_.end() && it->second > 0 && it->second <= 6) {
-          this->iz2_zone_count_ = it->second;
-        }
-      }
-
-      ESP_LOGI(TAG, "Components detected: thermostat=%s(v%.1f) axb=%s(v%.1f) iz2=%s(v%.1f, %d zones) vs=%s",
-               YESNO(this->has_thermostat_), therm_ver,
-               YESNO(this->has_axb_), axb_ver,
-               YESNO(this->has_iz2_), iz2_ver, this->iz2_zone_count_,
-               YESNO(this->has_vs_drive_));
-
-      // Build polling groups based on detected components
-      this->build_poll_groups_();
-      this->setup_phase_ = 0;
-      this->state_ = State::IDLE;
-
-      ESP_LOGI(TAG, "Setup complete, %d poll groups configured", this->poll_groups_.size());
+    if (!this->setup_complete_) {
+      // System ID and component status arrived together, and are decoded by now
+      this->save_setup_cache_();
+      this->finish_setup_();
+    } else if (this->active_group_ == &this->setup_group_) {
+      this->on_system_id_verified_();
+    } else if (this->active_group_ == &this->probe_group_) {
+      this->on_probe_result_(true);
+    } else if (this->active_group_ == nullptr || this->active_group_ == &this->readback_group_) {
+      // Write acknowledged or read back; carry on with the cycle it may have cut into
+      this->resume_cycle_();
     } else {
       // Normal polling cycle - advance to next group or back to idle
-      this->current_poll_group_++;
-      if (this->current_poll_group_ < this->poll_groups_.size()) {
-        // Small delay between groups
-        this->poll_next_group_();
-      } else {
-        this->state_ = State::IDLE;
-      }
+      this->advance_cycle_();
     }
   }
 }
 
-void WaterFurnace::dispatch_register_(uint16_t addr, uint16_t value) {
-  for (auto &listener : this->listeners_) {
-    if (listener.address == addr) {
-      listener.callback(value);
-    }
+void WaterFurnace::on_setup_read_() {
+  // Decoded before dispatch: text sensors publish the model and serial from their listeners
+  SetupCache before = this->setup_snapshot_();
+  this->decode_system_id_();
+  this->decode_components_();
+  if (!this->setup_complete_)
+    return;
+
+  // Verifying a cached setup: the unit, its firmware or its boards may have changed
+  SetupCache after = this->setup_snapshot_();
+  this->detection_changed_ = !same_detection_(before, after);
+  if (this->detection_changed_) {
+    ESP_LOGW(TAG, "System detection changed (was model=%s serial=%s program=%s axb=%s iz2=%s)", before.model_number,
+             before.serial_number, before.abc_program, YESNO(before.has_axb), YESNO(before.has_iz2));
   }
 }
 
-void WaterFurnace::read_system_id_() {
-  auto ranges = get_system_id_ranges();
+bool WaterFurnace::same_detection_(const SetupCache &a, const SetupCache &b) {
+  return strcmp(a.abc_program, b.abc_program) == 0 && strcmp(a.model_number, b.model_number) == 0 &&
+         strcmp(a.serial_number, b.serial_number) == 0 && a.has_thermostat == b.has_thermostat &&
+         a.has_axb == b.has_axb && a.has_iz2 == b.has_iz2 && a.has_aoc == b.has_aoc && a.has_moc == b.has_moc &&
+         a.has_vs_drive == b.has_vs_drive && a.has_energy_monitoring == b.has_energy_monitoring &&
+         a.awl_thermostat == b.awl_thermostat && a.awl_axb == b.awl_axb && a.awl_iz2 == b.awl_iz2 &&
+         a.iz2_zone_count == b.iz2_zone_count;
+}
+
+void WaterFurnace::decode_system_id_() {
+  this->abc_program_ = this->decode_string_(REG_ABC_PROGRAM, 4);
+  this->model_number_ = this->decode_string_(REG_MODEL_NUMBER, 12);
+  this->serial_number_ = this->decode_string_(REG_SERIAL_NUMBER, 5);
 
-  // Build expected addresses list
-  this->expected_addresses_.clear();
-  for (const auto &range : ranges) {
-    for (uint16_t i = 0; i < range.second; i++) {
-      this->expected_addresses_.push_back(range.first + i);
+  // Trim trailing spaces/nulls
+  for (auto *str : {&this->abc_program_, &this->model_number_, &this->serial_number_}) {
+    while (!str->empty() && (str->back() == ' ' || str->back() == '\0'))
+      str->pop_back();
+  }
+
+  // Detect VS drive from program name
+  this->has_vs_drive_ = (this->abc_program_ == "ABCVSP" ||
+                          this->abc_program_ == "ABCVSPR" ||
+                          this->abc_program_ == "ABCSPLVS");
+
+  ESP_LOGI(TAG, "System ID: program=%s model=%s serial=%s",
+           this->abc_program_.c_str(), this->model_number_.c_str(),
+           this->serial_number_.c_str());
+}
+
+void WaterFurnace::decode_components_() {
+  // Decode component status from registers
+  auto check_component = [this](uint16_t status_reg) -> bool {
+    uint16_t status;
+    if (!this->get_register(status_reg, status))
+      return false;
+    return status != COMPONENT_REMOVED && status != COMPONENT_MISSING && status != 0;
+  };
+
+  auto get_version = [this](uint16_t version_reg) -> float {
+    uint16_t version;
+    if (!this->get_register(version_reg, version))
+      return 0.0f;
+    return version / 100.0f;
+  };
+
+  this->has_thermostat_ = check_component(REG_THERMOSTAT_STATUS);
+  this->has_axb_ = check_component(REG_AXB_STATUS);
+  this->has_iz2_ = check_component(REG_IZ2_STATUS);
+  this->has_aoc_ = check_component(REG_AOC_STATUS);
+  this->has_moc_ = check_component(REG_MOC_STATUS);
+
+  // AWL versions
+  float therm_ver = get_version(REG_THERMOSTAT_VERSION);
+  float axb_ver = get_version(REG_AXB_VERSION);
+  float iz2_ver = get_version(REG_IZ2_VERSION);
+
+  this->awl_thermostat_ = this->has_thermostat_ && therm_ver >= 3.0f;
+  this->awl_axb_ = this->has_axb_ && axb_ver >= 2.0f;
+  this->awl_iz2_ = this->has_iz2_ && iz2_ver >= 2.0f;
+
+  // Energy monitoring available if AXB present
+  this->has_energy_monitoring_ = this->has_axb_;
+
+  // IZ2 zone count
+  this->iz2_zone_count_ = 0;
+  if (this->awl_iz2_) {
+    uint16_t zones;
+    if (this->get_register(REG_IZ2_ZONE_COUNT, zones) && zones > 0 && zones <= 6) {
+      this->iz2_zone_count_ = zones;
     }
   }
 
-  auto frame = build_read_ranges_request(ranges);
-  this->send_frame_(frame);
-  this->state_ = State::WAITING_RESPONSE;
+  ESP_LOGI(TAG, "Components detected: thermostat=%s(v%.1f) axb=%s(v%.1f) iz2=%s(v%.1f, %d zones) vs=%s",
+           YESNO(this->has_thermostat_), therm_ver,
+           YESNO(this->has_axb_), axb_ver,
+           YESNO(this->has_iz2_), iz2_ver, this->iz2_zone_count_,
+           YESNO(this->has_vs_drive_));
 }
 
-void WaterFurnace::detect_components_() {
-  auto ranges = get_component_detect_ranges();
+void WaterFurnace::finish_setup_() {
+  // Build polling groups based on detected components
+  this->build_poll_groups_();
+  this->setup_complete_ = true;
+  this->publish_diagnostic_(Diagnostic::POLL_INTERVAL, this->get_update_interval() / 1000.0f);
+  this->state_ = State::IDLE;
 
-  this->expected_addresses_.clear();
-  for (const auto &range : ranges) {
-    for (uint16_t i = 0; i < range.second; i++) {
-      this->expected_addresses_.push_back(range.first + i);
-    }
+  ESP_LOGI(TAG, "Setup complete, %u poll rates configured", static_cast<unsigned>(this->poll_rates_.size()));
+}
+
+bool WaterFurnace::load_setup_cache_() {
+  SetupCache cache{};
+  if (!this->setup_cache_pref_.load(&cache) || cache.version != SETUP_CACHE_VERSION || cache.model_number[0] == '\0')
+    return false;
+  // Always terminated, whatever flash held
+  cache.abc_program[sizeof(cache.abc_program) - 1] = '\0';
+  cache.model_number[sizeof(cache.model_number) - 1] = '\0';
+  cache.serial_number[sizeof(cache.serial_number) - 1] = '\0';
+  this->abc_program_ = cache.abc_program;
+  this->model_number_ = cache.model_number;
+  this->serial_number_ = cache.serial_number;
+  this->has_thermostat_ = cache.has_thermostat;
+  this->has_axb_ = cache.has_axb;
+  this->has_iz2_ = cache.has_iz2;
+  this->has_aoc_ = cache.has_aoc;
+  this->has_moc_ = cache.has_moc;
+  this->has_vs_drive_ = cache.has_vs_drive;
+  this->has_energy_monitoring_ = cache.has_energy_monitoring;
+  this->awl_thermostat_ = cache.awl_thermostat;
+  this->awl_axb_ = cache.awl_axb;
+  this->awl_iz2_ = cache.awl_iz2;
+  this->iz2_zone_count_ = cache.iz2_zone_count;
+  size_t excluded = std::min<size_t>(cache.excluded_count, sizeof(cache.excluded) / sizeof(cache.excluded[0]));
+  this->excluded_registers_.assign(cache.excluded, cache.excluded + excluded);
+  std::sort(this->excluded_registers_.begin(), this->excluded_registers_.end());
+  return true;
+}
+
+void WaterFurnace::save_setup_cache_() {
+  SetupCache cache = this->setup_snapshot_();
+  this->setup_cache_pref_.save(&cache);
+}
+
+WaterFurnace::SetupCache WaterFurnace::setup_snapshot_() const {
+  SetupCache cache{};
+  cache.version = SETUP_CACHE_VERSION;
+  strncpy(cache.abc_program, this->abc_program_.c_str(), sizeof(cache.abc_program) - 1);
+  strncpy(cache.model_number, this->model_number_.c_str(), sizeof(cache.model_number) - 1);
+  strncpy(cache.serial_number, this->serial_number_.c_str(), sizeof(cache.serial_number) - 1);
+  cache.has_thermostat = this->has_thermostat_;
+  cache.has_axb = this->has_axb_;
+  cache.has_iz2 = this->has_iz2_;
+  cache.has_aoc = this->has_aoc_;
+  cache.has_moc = this->has_moc_;
+  cache.has_vs_drive = this->has_vs_drive_;
+  cache.has_energy_monitoring = this->has_energy_monitoring_;
+  cache.awl_thermostat = this->awl_thermostat_;
+  cache.awl_axb = this->awl_axb_;
+  cache.awl_iz2 = this->awl_iz2_;
+  cache.iz2_zone_count = this->iz2_zone_count_;
+  // Exclusions beyond what fits are found again by bisection
+  for (uint16_t addr : this->excluded_registers_) {
+    if (cache.excluded_count == sizeof(cache.excluded) / sizeof(cache.excluded[0]))
+      break;
+    cache.excluded[cache.excluded_count++] = addr;
   }
+  return cache;
+}
 
-  auto frame = build_read_ranges_request(ranges);
-  this->send_frame_(frame);
-  this->state_ = State::WAITING_RESPONSE;
+void WaterFurnace::on_system_id_verified_() {
+  this->verify_system_id_ = false;
+  if (!this->detection_changed_) {
+    ESP_LOGD(TAG, "Cached system detection verified");
+    this->state_ = State::IDLE;
+    return;
+  }
+
+  // A different unit, controller firmware or set of boards, decoded by on_setup_read_():
+  // re-plan for it right away
+  this->detection_changed_ = false;
+  this->excluded_registers_.clear();
+  this->bisector_.clear();
+  this->save_setup_cache_();
+  this->finish_setup_();
 }
 
-void WaterFurnace::build_poll_groups_() {
-  this->poll_groups_.clear();
+void WaterFurnace::on_group_rejected_(const PollGroup &group) {
+  group.failures++;
+  group.consecutive_rejections++;
+  if (group.consecutive_rejections < BISECT_AFTER_REJECTIONS || group.bisected || this->bisector_.active())
+    return;
+  ESP_LOGW(TAG, "Poll group of %u registers rejected %u times in a row, searching for the unsupported register",
+           static_cast<unsigned>(group.addresses.size()), static_cast<unsigned>(group.consecutive_rejections));
+  group.bisected = true;
+  group.consecutive_rejections = 0;
+  this->bisector_.start(group.addresses);
+}
 
-  // Group 0: Core thermostat/status (always)
-  {
-    PollGroup group;
-    group.ranges = get_thermostat_ranges();
-    this->poll_groups_.push_back(std::move(group));
+void WaterFurnace::send_probe_() {
+  this->probe_group_ = PollGroup{};
+  this->probe_group_.ranges = this->bisector_.probe();
+  this->prepare_group_(this->probe_group_);
+  this->send_group_(this->probe_group_);
+}
+
+void WaterFurnace::on_probe_result_(bool accepted) {
+  this->bisector_.report(accepted);
+  this->state_ = State::IDLE;
+  if (this->bisector_.active())
+    return;
+
+  const auto &found = this->bisector_.found();
+  if (found.empty()) {
+    ESP_LOGD(TAG, "Bisection finished after %u probes, no register rejected on its own",
+             static_cast<unsigned>(this->bisector_.probes()));
+    return;
+  }
+  for (uint16_t addr : found) {
+    ESP_LOGW(TAG, "Register %u rejected by the controller, no longer polled", addr);
+    this->excluded_registers_.push_back(addr);
   }
+  std::sort(this->excluded_registers_.begin(), this->excluded_registers_.end());
+  this->excluded_registers_.erase(std::unique(this->excluded_registers_.begin(), this->excluded_registers_.end()),
+                                  this->excluded_registers_.end());
+  this->bisector_.clear();
+  this->poll_groups_dirty_ = true;
+  this->save_setup_cache_();
+}
 
-  // Group 0b: Thermostat config (if AWL thermostat, single zone)
-  // Separate group because registers 12005-12006 are across the 12100 breakpoint
-  if (this->awl_thermostat_ && !this->has_iz2_) {
-    PollGroup group;
-    group.individual = get_thermostat_config_registers();
-    this->poll_groups_.push_back(std::move(group));
+void WaterFurnace::advance_cycle_() {
+  this->current_poll_group_++;
+  if (!this->cycle_in_progress_())
+    this->publish_bus_stats_();
+  this->resume_cycle_();
+}
+
+void WaterFurnace::resume_cycle_() {
+  // Writes and their read-back go out between groups instead of waiting for the cycle to finish
+  if (!this->pending_writes_.empty()) {
+    uint32_t id = this->transaction_.id;
+    this->process_pending_writes_();
+    if (this->transaction_.id != id)
+      return;
+  }
+  if (!this->readback_pending_.empty()) {
+    this->send_readback_();
+    return;
+  }
+  if (this->cycle_in_progress_()) {
+    this->poll_next_group_();
+  } else {
+    this->state_ = State::IDLE;
   }
+}
 
-  // Group 1: AXB performance (if AXB present)
-  if (this->has_axb_) {
-    PollGroup group;
-    group.ranges = get_axb_ranges();
-    this->poll_groups_.push_back(std::move(group));
+void WaterFurnace::dispatch_group_(const PollGroup &group) {
+  uint32_t now = millis();
+  // A read-back settles what entities showed ahead of the write, changed or not
+  bool readback = &group == &this->readback_group_;
+  if (readback) {
+    ESP_LOGD(TAG, "Read back %u registers %" PRIu32 "ms after the write", static_cast<unsigned>(group.addresses.size()),
+             now - this->readback_write_time_);
+  }
+  for (const auto &page : group.pages) {
+    for (size_t i = 0; i < page.slots.size(); i++) {
+      if (page.slots[i] != RegisterCache::NO_SLOT)
+        this->dispatch_register_(page.listener_spans[i], page.slots[i], this->registers_.value(page.slots[i]), now,
+                                 readback);
+    }
   }
+  for (const auto &page : group.pages) {
+    for (uint16_t slot : page.slots) {
+      if (slot != RegisterCache::NO_SLOT)
+        this->registers_.clear_changed(slot);
+    }
+  }
+}
 
-  // Group 2: Power/energy (if energy monitoring)
-  if (this->has_energy_monitoring_) {
-    PollGroup group;
-    group.ranges = get_power_ranges();
-    this->poll_groups_.push_back(std::move(group));
+void WaterFurnace::dispatch_register_(ListenerSpan span, uint16_t slot, uint16_t value, uint32_t now, bool force) {
+  if (span.empty() || slot == RegisterCache::NO_SLOT)
+    return;
+  // Re-send unchanged values now and then so a restarted consumer still gets the state
+  bool heartbeat = now - this->registers_.last_dispatch(slot) >= this->force_publish_interval_;
+  bool dispatched = false;
+  for (uint16_t l = span.begin; l < span.end; l++) {
+    auto &listener = this->listeners_[l];
+    // Multi-register listeners compare against what they last got, not the change flags
+    uint32_t words = 0;
+    bool complete = listener.count > 1 && this->registers_.words(slot, listener.count, words);
+    bool changed = listener.count > 1 ? !listener.has_words || !complete || words != listener.last_words
+                                      : this->registers_.changed(slot);
+    if (force || heartbeat || listener.dispatch_unchanged || changed) {
+      listener.callback(value);
+      listener.last_words = words;
+      listener.has_words = complete;
+      dispatched = true;
+    }
   }
+  if (dispatched && (heartbeat || this->registers_.changed(slot)))
+    this->registers_.set_last_dispatch(slot, now);
+  if (dispatched && !this->first_dispatch_) {
+    this->first_dispatch_ = true;
+    this->startup_time_ = now - this->setup_time_;
+    ESP_LOGI(TAG, "First data %" PRIu32 "ms after setup", this->startup_time_);
+    this->publish_diagnostic_(Diagnostic::STARTUP_TIME, this->startup_time_);
+  }
+}
 
-  // Group 3: VS Drive (if VS)
-  if (this->has_vs_drive_) {
-    PollGroup group;
-    group.ranges = get_vs_drive_ranges();
-    this->poll_groups_.push_back(std::move(group));
+void WaterFurnace::publish_diagnostic_(Diagnostic diagnostic, float value) {
+  for (auto &listener : this->diagnostic_listeners_) {
+    if (listener.diagnostic == diagnostic) {
+      listener.callback(value);
+    }
   }
+}
 
-  // Group 4: IZ2 zones (if IZ2)
-  if (this->awl_iz2_ && this->iz2_zone_count_ > 0) {
-    PollGroup group;
-    group.ranges = get_iz2_ranges(this->iz2_zone_count_);
-    this->poll_groups_.push_back(std::move(group));
+void WaterFurnace::on_equipment_state_() {
+  uint16_t outputs = 0;
+  uint16_t fault = 0;
+  if (!this->get_register(REG_SYSTEM_OUTPUTS, outputs))
+    return;
+  this->get_register(REG_LAST_FAULT, fault);
+
+  uint16_t running = outputs & (OUTPUT_CC | OUTPUT_CC2 | OUTPUT_EH1 | OUTPUT_EH2 | OUTPUT_BLOWER);
+  uint16_t faulted = outputs & (OUTPUT_LOCKOUT | OUTPUT_ALARM);
+  uint32_t state = (static_cast<uint32_t>(fault) << 16) | running | faulted;
+
+  uint32_t now = millis();
+  if (this->has_equipment_state_ && state != this->equipment_state_) {
+    ESP_LOGD(TAG, "Equipment state changed: outputs=0x%04X fault=0x%04X", outputs, fault);
+    this->last_state_change_ = now;
+    this->set_polling_mode_(PollingMode::TRANSITION);
   }
+  this->equipment_state_ = state;
+  this->has_equipment_state_ = true;
+
+  // Still inside the transition window
+  if (this->polling_mode_ == PollingMode::TRANSITION && now - this->last_state_change_ < this->transition_duration_)
+    return;
+
+  this->set_polling_mode_((running != 0 || faulted != 0) ? PollingMode::RUNNING : PollingMode::IDLE);
 }
 
-void WaterFurnace::poll_next_group_() {
-  if (this->current_poll_group_ >= this->poll_groups_.size())
+void WaterFurnace::set_polling_mode_(PollingMode mode) {
+  if (mode == this->polling_mode_)
     return;
+  this->polling_mode_ = mode;
+
+  uint32_t interval;
+  switch (mode) {
+    case PollingMode::IDLE:
+      interval = this->idle_interval_;
+      break;
+    case PollingMode::TRANSITION:
+      interval = this->transition_interval_;
+      break;
+    default:
+      interval = this->running_interval_;
+      break;
+  }
+  ESP_LOGI(TAG, "Polling mode %s, update interval %" PRIu32 "ms", this->polling_mode_str(), interval);
+
+  this->set_update_interval(interval);
+  this->stop_poller();
+  this->start_poller();
+  // Sample right away when the equipment changes state, entities on their own rates included
+  if (mode == PollingMode::TRANSITION) {
+    for (auto &rate : this->poll_rates_)
+      rate.due = true;
+  }
+
+  this->publish_diagnostic_(Diagnostic::POLL_INTERVAL, interval / 1000.0f);
+}
+
+uint32_t WaterFurnace::rate_interval_(const PollRate &rate) const {
+  // Entity intervals are the running rates; idle and transition scale them like the default
+  // rate, though a transition polls nothing faster than transition_interval unless asked to
+  if (this->polling_mode_ == PollingMode::IDLE)
+    return static_cast<uint64_t>(rate.interval) * this->idle_interval_ / this->running_interval_;
+  if (this->polling_mode_ == PollingMode::TRANSITION) {
+    uint32_t scaled = static_cast<uint64_t>(rate.interval) * this->transition_interval_ / this->running_interval_;
+    return std::max(scaled, std::min(rate.interval, this->transition_interval_));
+  }
+  return rate.interval;
+}
+
+const char *WaterFurnace::polling_mode_str() const {
+  switch (this->polling_mode_) {
+    case PollingMode::IDLE:
+      return "Idle";
+    case PollingMode::RUNNING:
+      return "Running";
+    case PollingMode::TRANSITION:
+      return "Transition";
+    default:
+      return "Fixed";
+  }
+}
 
-  const auto &group = this->poll_groups_[this->current_poll_group_];
+void WaterFurnace::read_setup_registers_() {
+  // System ID and component detection fit one request together
+  RegisterRanges ranges = get_system_id_ranges();
+  for (const auto &range : get_component_detect_ranges())
+    ranges.push_back(range);
+  this->setup_group_ = PollGroup{};
+  this->setup_group_.ranges = normalize_ranges(ranges);
+  this->listeners_.freeze();
+  this->prepare_group_(this->setup_group_);
+  this->send_group_(this->setup_group_);
+}
 
-  // Build expected addresses
-  this->expected_addresses_.clear();
-  for (const auto &range : group.ranges) {
-    for (uint16_t i = 0; i < range.second; i++) {
-      this->expected_addresses_.push_back(range.first + i);
+void WaterFurnace::build_poll_groups_() {
+  this->listeners_.freeze();
+  this->poll_rates_.clear();
+  this->cycle_plans_.clear();
+  this->poll_groups_ = nullptr;
+  this->active_group_ = nullptr;
+  this->polled_register_count_ = 0;
+
+  // Everything the detected subsystems can provide
+  RegisterRanges available = get_thermostat_ranges();
+  auto append = [&available](const RegisterRanges &more) {
+    available.insert(available.end(), more.begin(), more.end());
+  };
+
+  // AXB performance (if AXB present)
+  if (this->has_axb_)
+    append(get_axb_ranges());
+
+  // Power/energy (if energy monitoring)
+  if (this->has_energy_monitoring_)
+    append(get_power_ranges());
+
+  // VS Drive (if VS)
+  if (this->has_vs_drive_)
+    append(get_vs_drive_ranges());
+
+  // IZ2 zones (if IZ2)
+  if (this->awl_iz2_ && this->iz2_zone_count_ > 0)
+    append(get_iz2_ranges(this->iz2_zone_count_));
+
+  // Thermostat config (if AWL thermostat, single zone)
+  // Kept out of the func 65 ranges because registers 12005-12006 are across the 12100 breakpoint
+  std::vector<uint16_t> config_registers;
+  if (this->awl_thermostat_ && !this->has_iz2_)
+    config_registers = get_thermostat_config_registers();
+
+  this->available_register_count_ = count_registers(normalize_ranges(available)) + config_registers.size();
+
+  // Only poll what some entity consumes, each address at the fastest rate any of its
+  // listeners asked for. Interval 0 follows the hub's update_interval.
+  std::map<uint16_t, uint32_t> address_rates;
+  uint32_t default_interval = this->get_update_interval();
+  auto effective = [default_interval](uint32_t interval) { return interval == 0 ? default_interval : interval; };
+  this->pairs_.clear();
+  for (const auto &listener : this->listeners_) {
+    if (listener.count == 2)
+      this->pairs_.push_back(listener.address);
+    for (uint8_t i = 0; i < listener.count; i++) {
+      uint16_t addr = listener.address + i;
+      if (std::binary_search(this->excluded_registers_.begin(), this->excluded_registers_.end(), addr))
+        continue;
+      auto it = address_rates.find(addr);
+      if (it == address_rates.end() || effective(listener.update_interval) < effective(it->second))
+        address_rates[addr] = listener.update_interval;
     }
   }
-  for (uint16_t addr : group.individual) {
-    this->expected_addresses_.push_back(addr);
+
+  std::map<uint32_t, std::vector<uint16_t>> rate_addresses;
+  for (const auto &entry : address_rates)
+    rate_addresses[entry.second].push_back(entry.first);
+
+  // Fold the slowest rates into the last one allowed; those registers are polled faster than asked
+  if (rate_addresses.size() > MAX_POLL_RATES) {
+    ESP_LOGW(TAG, "More than %u distinct update intervals, slowest ones merged",
+             static_cast<unsigned>(MAX_POLL_RATES));
+    auto last = std::next(rate_addresses.begin(), MAX_POLL_RATES - 1);
+    for (auto it = std::next(last); it != rate_addresses.end(); it = rate_addresses.erase(it))
+      last->second.insert(last->second.end(), it->second.begin(), it->second.end());
+    std::sort(last->second.begin(), last->second.end());
   }
 
-  // Send the request
-  if (!group.ranges.empty() && group.individual.empty()) {
-    // All ranges - use func 65
-    auto frame = build_read_ranges_request(group.ranges);
-    this->send_frame_(frame);
-  } else if (group.ranges.empty() && !group.individual.empty()) {
-    // All individual - use func 66
-    auto frame = build_read_registers_request(group.individual);
-    this->send_frame_(frame);
-  } else {
-    // Mixed: convert ranges to individual addresses and use func 66
-    std::vector<uint16_t> all_addrs;
-    for (const auto &range : group.ranges) {
-      for (uint16_t i = 0; i < range.second; i++) {
-        all_addrs.push_back(range.first + i);
-      }
+  for (const auto &entry : rate_addresses) {
+    PollRate rate;
+    rate.interval = entry.first;
+    rate.due = true;  // A fresh plan starts with a full cycle rather than waiting for the next tick
+    rate.ranges = select_registers(available, entry.second);
+    for (uint16_t addr : config_registers) {
+      if (std::binary_search(entry.second.begin(), entry.second.end(), addr))
+        rate.individual.push_back(addr);
+    }
+    size_t registers = count_registers(rate.ranges) + rate.individual.size();
+    if (registers == 0)
+      continue;
+    this->polled_register_count_ += registers;
+    this->poll_rates_.push_back(std::move(rate));
+  }
+
+  // One cache slot per polled register
+  std::vector<uint16_t> cached = setup_addresses();
+  for (const auto &rate : this->poll_rates_) {
+    append_addresses(rate.ranges, cached);
+    cached.insert(cached.end(), rate.individual.begin(), rate.individual.end());
+  }
+  this->registers_.assign(cached);
+
+  std::sort(this->pairs_.begin(), this->pairs_.end());
+  // Plan every combination of due rates now if they all fit, so polling never has to
+  this->cycle_plans_.reserve(MAX_CYCLE_PLANS);
+  if (this->poll_rates_.size() < 32 && (1UL << this->poll_rates_.size()) - 1 <= MAX_CYCLE_PLANS) {
+    for (uint32_t due_mask = 1; due_mask < (1UL << this->poll_rates_.size()); due_mask++)
+      this->cycle_plan_(due_mask);
+  }
+
+  this->poll_groups_dirty_ = false;
+}
+
+void WaterFurnace::start_poll_cycle_(uint32_t now) {
+  // Merge every rate that is due into a single cycle
+  uint32_t due_mask = 0;
+  for (size_t i = 0; i < this->poll_rates_.size(); i++) {
+    auto &rate = this->poll_rates_[i];
+    if (rate.interval != 0 && now - rate.last_poll >= this->rate_interval_(rate))
+      rate.due = true;
+    if (!rate.due)
+      continue;
+    rate.due = false;
+    rate.last_poll = now;
+    due_mask |= 1UL << i;
+  }
+  if (due_mask == 0)
+    return;
+
+  const auto &groups = this->cycle_plan_(due_mask);
+  if (groups.empty())
+    return;
+
+  this->poll_groups_ = &groups;
+  this->current_poll_group_ = 0;
+  this->poll_next_group_();
+}
+
+const std::vector<WaterFurnace::PollGroup> &WaterFurnace::cycle_plan_(uint32_t due_mask) {
+  this->cycle_count_++;
+  CyclePlan *plan = nullptr;
+  for (auto &cached : this->cycle_plans_) {
+    if (cached.due_mask == due_mask) {
+      plan = &cached;
+      break;
     }
-    for (uint16_t addr : group.individual) {
-      all_addrs.push_back(addr);
+  }
+  if (plan == nullptr) {
+    // Only called between cycles, so the plan replaced is never the one being polled
+    if (this->cycle_plans_.size() < MAX_CYCLE_PLANS) {
+      this->cycle_plans_.emplace_back();
+      plan = &this->cycle_plans_.back();
+    } else {
+      plan = &*std::min_element(this->cycle_plans_.begin(), this->cycle_plans_.end(),
+                                [](const CyclePlan &a, const CyclePlan &b) { return a.last_used < b.last_used; });
+      ESP_LOGV(TAG, "Replacing the plan for due rates 0x%" PRIx32, plan->due_mask);
     }
+    plan->due_mask = due_mask;
+    this->plan_cycle_(*plan);
+  }
+  plan->last_used = this->cycle_count_;
+  return plan->groups;
+}
 
-    if (all_addrs.size() <= MAX_REGISTERS_PER_REQUEST) {
-      auto frame = build_read_registers_request(all_addrs);
-      this->send_frame_(frame);
+void WaterFurnace::plan_cycle_(CyclePlan &plan) {
+  RegisterRanges ranges;
+  std::vector<uint16_t> individual;
+  for (size_t i = 0; i < this->poll_rates_.size(); i++) {
+    if ((plan.due_mask & (1UL << i)) == 0)
+      continue;
+    const auto &rate = this->poll_rates_[i];
+    ranges.insert(ranges.end(), rate.ranges.begin(), rate.ranges.end());
+    individual.insert(individual.end(), rate.individual.begin(), rate.individual.end());
+  }
+
+  auto &groups = plan.groups;
+  groups.clear();
+  for (auto &frame_ranges : plan_read_ranges(ranges, this->bus_timing_, this->excluded_registers_, this->pairs_)) {
+    PollGroup group;
+    group.ranges = std::move(frame_ranges);
+    groups.push_back(std::move(group));
+  }
+  if (!individual.empty()) {
+    PollGroup group;
+    std::sort(individual.begin(), individual.end());
+    group.individual = std::move(individual);
+    groups.push_back(std::move(group));
+  }
+
+  for (auto &group : groups)
+    this->prepare_group_(group);
+}
+
+void WaterFurnace::prepare_group_(PollGroup &group) {
+  group.pages.clear();
+  group.addresses.clear();
+  // As many requests as the group needs, each func 65 or 66, whichever is smaller
+  for (auto &read : paginate_read(group.ranges, group.individual)) {
+    PollGroup::Page page;
+    if (read.func_code == FUNC_READ_RANGES) {
+      page.request = build_read_ranges_request(read.ranges);
     } else {
-      // Split if too many - just send ranges portion via func 65
-      auto frame = build_read_ranges_request(group.ranges);
-      this->send_frame_(frame);
-      // Individual registers will need to be a separate poll group
-      // This shouldn't happen with our current group sizes
-      ESP_LOGW(TAG, "Poll group too large, individual registers skipped");
+      page.request = build_read_registers_request(read.addresses);
     }
+    page.addresses = std::move(read.addresses);
+    // Resolve each response position to its cache slot and listeners once, so handling a
+    // response never searches
+    page.slots = this->registers_.resolve(page.addresses);
+    page.listener_spans = this->listeners_.resolve(page.addresses);
+    group.addresses.insert(group.addresses.end(), page.addresses.begin(), page.addresses.end());
+    group.pages.push_back(std::move(page));
   }
+  if (group.pages.size() > 1) {
+    ESP_LOGD(TAG, "Read of %u registers split into %u requests", static_cast<unsigned>(group.addresses.size()),
+             static_cast<unsigned>(group.pages.size()));
+  }
+}
 
-  this->state_ = State::WAITING_RESPONSE;
+void WaterFurnace::send_group_(const PollGroup &group) {
+  this->active_group_ = &group;
+  this->current_page_ = 0;
+  this->send_page_();
+}
+
+void WaterFurnace::send_page_() {
+  const auto &page = this->active_group_->pages[this->current_page_];
+  this->send_frame_(page.request.data(), page.request.size(), read_response_size(page.addresses.size()));
+}
+
+void WaterFurnace::poll_next_group_() {
+  if (!this->cycle_in_progress_())
+    return;
+
+  // Request bytes and expected addresses were prepared when the cycle was planned
+  this->send_group_(this->cycle_group_());
 }
 
 void WaterFurnace::process_pending_writes_() {
   if (this->pending_writes_.empty())
     return;
 
-  // Send all pending writes in one func 67 request
-  auto frame = build_write_registers_request(this->pending_writes_);
-  ESP_LOGD(TAG, "Sending %d register writes", this->pending_writes_.size());
+  // As many pending writes as fit in one func 67 request; the rest go before the next group
+  uint32_t latency = millis() - this->pending_writes_.oldest();
+  auto batch = this->pending_writes_.take();
+  size_t len = build_write_registers_request(batch, this->tx_frame_, sizeof(this->tx_frame_));
+  // Control-to-bus latency of the oldest write in the batch
+  this->write_latency_max_ = std::max(this->write_latency_max_, latency);
+  ESP_LOGD(TAG, "Sending %u register writes (queued %" PRIu32 "ms, %u left)", static_cast<unsigned>(batch.size()),
+           latency, static_cast<unsigned>(this->pending_writes_.size()));
+  this->publish_diagnostic_(Diagnostic::WRITE_LATENCY, latency);
+  if (len == 0) {
+    ESP_LOGW(TAG, "Write request exceeds frame size, dropped");
+    return;
+  }
+  this->queue_readback_(batch);
+
+  // No register data expected back, just the echo
+  this->active_group_ = nullptr;
 
-  // Build expected addresses (for write, we don't expect data back, just echo)
-  this->expected_addresses_.clear();
+  // Echo: slave + func + CRC(2)
+  this->send_frame_(this->tx_frame_, len, 4);
+}
 
-  this->pending_writes_.clear();
-  this->send_frame_(frame);
-  this->state_ = State::WAITING_RESPONSE;
+void WaterFurnace::queue_readback_(const std::vector<std::pair<uint16_t, uint16_t>> &writes) {
+  // Only registers something polls: there is no listener to confirm to otherwise, and
+  // write-only registers would get the whole read rejected
+  for (const auto &write : writes) {
+    if (this->registers_.contains(write.first))
+      this->readback_pending_.push_back(write.first);
+    for (const auto &readback : this->readback_registers_) {
+      if (readback.first == write.first && this->registers_.contains(readback.second))
+        this->readback_pending_.push_back(readback.second);
+    }
+  }
+  std::sort(this->readback_pending_.begin(), this->readback_pending_.end());
+  this->readback_pending_.erase(std::unique(this->readback_pending_.begin(), this->readback_pending_.end()),
+                                this->readback_pending_.end());
+  this->readback_write_time_ = millis();
+}
+
+void WaterFurnace::send_readback_() {
+  // Func 66, split over several requests if it has to be
+  this->readback_group_ = PollGroup{};
+  this->readback_group_.individual = std::move(this->readback_pending_);
+  this->readback_pending_.clear();
+  this->prepare_group_(this->readback_group_);
+  this->send_group_(this->readback_group_);
+}
+
+void WaterFurnace::on_readback_failed_() {
+  // The next regular poll hands these registers to their listeners even if they did not
+  // change, so state published ahead of a write the controller ignored is still corrected
+  for (const auto &page : this->readback_group_.pages) {
+    for (uint16_t slot : page.slots) {
+      if (slot != RegisterCache::NO_SLOT)
+        this->registers_.mark_changed(slot);
+    }
+  }
 }
 
-std::string WaterFurnace::decode_string_(const std::map<uint16_t, uint16_t> &regs,
-                                          uint16_t start, uint8_t num_regs) {
+std::string WaterFurnace::decode_string_(uint16_t start, uint8_t num_regs) const {
   std::string result;
   for (uint8_t i = 0; i < num_regs; i++) {
-    auto it = regs.find(start + i);
-    if (it == regs.end())
+    uint16_t val;
+    if (!this->get_register(start + i, val))
       break;
-    uint16_t val = it->second;
     char hi = (val >> 8) & 0xFF;
     char lo = val & 0xFF;
     if (hi != 0)
@@ -1,21 +1,54 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
+#include "bus_worker.h"
+#include "frame_assembler.h"
+#include "listener_table.h"
+#include "poll_planner.h"
 #include "protocol.h"
+#include "range_bisector.h"
+#include "register_cache.h"
 #include "registers.h"
+#include "rtt_tracker.h"
+#include "write_queue.h"
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace esphome {
 namespace waterfurnace {
 
-struct RegisterListener {
-  uint16_t address;
-  std::function<void(uint16_t)> callback;
+// Hub-level values (not backed by a register) that entities can subscribe to
+enum class Diagnostic : uint8_t {
+  POLL_INTERVAL,     // Update interval currently in effect (s)
+  RX_SKIPPED_BYTES,  // Received bytes discarded while resynchronizing (total)
+  RX_LENGTH_FRAMES,  // Responses delimited by their header length (total)
+  RX_IDLE_FRAMES,    // Responses delimited by the line going idle (total)
+  TURNAROUND_P50,    // Median response turnaround over recent reads (ms)
+  TURNAROUND_P95,    // 95th percentile response turnaround (ms)
+  TURNAROUND_LIMIT,  // Turnaround a read is currently allowed before it times out (ms)
+  STARTUP_TIME,      // From setup() to the first register handed to an entity (ms)
+  WRITE_LATENCY,     // How long the last write batch waited in the queue before going out (ms)
+  RX_STALE_RESPONSES,  // Responses discarded for not answering the request in flight (total)
+};
+
+struct DiagnosticListener {
+  Diagnostic diagnostic;
+  std::function<void(float)> callback;
+};
+
+// Adaptive polling modes
+enum class PollingMode : uint8_t {
+  FIXED,       // Adaptive polling disabled
+  IDLE,        // Compressor, blower and aux off
+  RUNNING,     // Equipment running in a steady state
+  TRANSITION,  // Equipment state changed recently
 };
 
 class WaterFurnace : public PollingComponent, public uart::UARTDevice {
@@ -27,13 +60,41 @@ class WaterFurnace : public PollingComponent, public uart::UARTDevice {
   float get_setup_priority() const override { return setup_priority::DATA; }
 
   // Listener registration (called by child entities during their setup)
-  void register_listener(uint16_t register_addr, std::function<void(uint16_t)> callback);
+  // update_interval (ms) polls the register at its own rate; 0 follows the hub's update_interval.
+  // Callbacks only run when the value changed (or on the force publish heartbeat) unless
+  // dispatch_unchanged is set. count > 1 watches consecutive registers: the callback gets the
+  // first register's value and runs when any of them changed; read the rest with get_register().
+  void register_listener(uint16_t register_addr, std::function<void(uint16_t)> callback,
+                         uint32_t update_interval = 0, bool dispatch_unchanged = false, uint8_t count = 1);
+
+  void register_diagnostic_listener(Diagnostic diagnostic, std::function<void(float)> callback);
 
   // Write interface (called by climate/switch entities)
   void write_register(uint16_t addr, uint16_t value);
+  // Read read_addr back right after a write to write_addr, to confirm it (the written register
+  // itself is read back whenever it is polled). Listeners of registers read back get the value
+  // even if it did not change, so state published ahead of the write is corrected. If the
+  // read-back fails, the next regular poll of those registers does the same.
+  void register_readback(uint16_t write_addr, uint16_t read_addr);
 
   // Configuration
   void set_flow_control_pin(GPIOPin *pin) { flow_control_pin_ = pin; }
+  // Run the bus exchange in a task of its own (ESP32) instead of the main loop
+  void set_bus_task(bool bus_task) { bus_task_ = bus_task; }
+  void set_force_publish_interval(uint32_t interval) { force_publish_interval_ = interval; }
+  // idle_timeout (us) is the shortest silence that ends a frame; t3.5 is used if longer
+  void set_framing(FramingMode mode, uint32_t idle_timeout) {
+    rx_.set_framing(mode);
+    rx_idle_timeout_ = idle_timeout;
+  }
+  void set_adaptive_polling(uint32_t idle_interval, uint32_t running_interval, uint32_t transition_interval,
+                            uint32_t transition_duration) {
+    adaptive_polling_ = true;
+    idle_interval_ = idle_interval;
+    running_interval_ = running_interval;
+    transition_interval_ = transition_interval;
+    transition_duration_ = transition_duration;
+  }
 
   // Accessors for detected capabilities
   bool has_thermostat() const { return has_thermostat_; }
@@ -48,52 +109,148 @@ class WaterFurnace : public PollingComponent, public uart::UARTDevice {
   const std::string &serial_number() const { return serial_number_; }
   const std::string &abc_program() const { return abc_program_; }
 
+  // Adaptive polling state
+  PollingMode polling_mode() const { return polling_mode_; }
+  const char *polling_mode_str() const;
+
   // Register cache access (for entities that need multi-register values)
   bool get_register(uint16_t addr, uint16_t &value) const;
 
  protected:
   // Protocol communication
-  void send_frame_(const std::vector<uint8_t> &frame);
-  bool read_frame_(std::vector<uint8_t> &frame);
-  void process_response_(const std::vector<uint8_t> &frame);
+  // response_len is the size of the expected answer, for the response timeout
+  // Queues the frame and enters TRANSMITTING; loop() moves on to WAITING_RESPONSE once it is out
+  void send_frame_(const uint8_t *frame, size_t len, size_t response_len);
+  void finish_transmit_();  // Release the bus and start the response timer
+  void discard_input_();  // Drop received bytes left over from earlier requests
+  size_t read_frame_();  // Length of the frame left in rx_frame_, 0 if none yet
+  void process_response_(const uint8_t *frame, size_t len);
+  // A response arrived (complete at received_us): feed its turnaround to the timeout estimate
+  void record_response_(uint32_t received_us);
+  // Bus task mode: take the result of the request in flight, if it is in
+  void poll_bus_worker_(uint32_t now);
+  // The request in flight failed: retry it once, then back off
+  void fail_request_(uint32_t now);
+  void enter_backoff_(uint32_t now);
+  void publish_bus_stats_();
 
   // Polling
   void poll_next_group_();
+  void advance_cycle_();  // Move on to the next group of the cycle (writes first), or finish it
+  void resume_cycle_();   // Pending writes and read-backs, then the group that was next, if a cycle is running
+  bool cycle_in_progress_() const {
+    return this->poll_groups_ != nullptr && this->current_poll_group_ < this->poll_groups_->size();
+  }
   void process_pending_writes_();
+  void queue_readback_(const std::vector<std::pair<uint16_t, uint16_t>> &writes);
+  void send_readback_();
+  void on_readback_failed_();
 
   // Setup phases
-  void read_system_id_();
-  void detect_components_();
+  void read_setup_registers_();  // System ID and component detection in one request
+  void on_setup_read_();         // Setup registers cached, not yet dispatched
+  void decode_system_id_();
+  void decode_components_();
+  void finish_setup_();
   void build_poll_groups_();
+  void start_poll_cycle_(uint32_t now);
+
+  // Dispatch a cached value to its listeners if it changed, or to all of them if forced
+  void dispatch_register_(ListenerSpan span, uint16_t slot, uint16_t value, uint32_t now, bool force = false);
+  void publish_diagnostic_(Diagnostic diagnostic, float value);
 
-  // Dispatch register values to listeners
-  void dispatch_register_(uint16_t addr, uint16_t value);
+  // Adaptive polling
+  void on_equipment_state_();
+  void set_polling_mode_(PollingMode mode);
 
-  // Decode string from consecutive registers
-  static std::string decode_string_(const std::map<uint16_t, uint16_t> &regs,
-                                     uint16_t start, uint8_t num_regs);
+  // Decode string from consecutive cached registers
+  std::string decode_string_(uint16_t start, uint8_t num_regs) const;
 
   // State machine
   enum class State : uint8_t {
-    SETUP_READ_ID,
-    SETUP_DETECT_COMPONENTS,
+    SETUP,
     IDLE,
+    TRANSMITTING,
     WAITING_RESPONSE,
     ERROR_BACKOFF,
   };
-  State state_{State::SETUP_READ_ID};
-  uint8_t setup_phase_{0};
+  State state_{State::SETUP};
+  bool setup_complete_{false};
 
-  // Polling groups
+  // One read of a poll cycle (due rates merged by the planner). Usually a single request;
+  // a read too large for one is split into pages sent back to back and dispatched together.
   struct PollGroup {
+    std::vector<std::pair<uint16_t, uint16_t>> ranges;   // Func 65, or 66 where that is smaller
+    std::vector<uint16_t> individual;                      // Always func 66
+    // Built once by prepare_group_() and reused every time the group is polled
+    struct Page {
+      std::vector<uint8_t> request;                        // Serialized frame, CRC included
+      std::vector<uint16_t> addresses;                     // Response order
+      std::vector<uint16_t> slots;                         // Cache slot of each response position
+      std::vector<ListenerSpan> listener_spans;            // Listeners of each response position
+    };
+    std::vector<Page> pages;
+    std::vector<uint16_t> addresses;                       // Of every page, in order
+    // Health, updated while the plan itself stays const
+    mutable uint32_t failures{0};                          // Timeouts and exception responses
+    mutable uint8_t consecutive_rejections{0};             // Exception responses in a row
+    mutable bool bisected{false};                          // Already searched for a bad register
+  };
+  void prepare_group_(PollGroup &group);
+  void send_group_(const PollGroup &group);
+  void send_page_();  // Page current_page_ of active_group_
+  void dispatch_group_(const PollGroup &group);
+
+  // Registers polled at the same rate
+  struct PollRate {
+    uint32_t interval{0};                                  // ms, 0 = update_interval
     std::vector<std::pair<uint16_t, uint16_t>> ranges;   // For func 65
     std::vector<uint16_t> individual;                      // For func 66
+    uint32_t last_poll{0};
+    bool due{false};
+  };
+  std::vector<PollRate> poll_rates_;
+  // A rate's interval in the current adaptive polling mode
+  uint32_t rate_interval_(const PollRate &rate) const;
+
+  // Rates are cached by a bitmask of the ones due
+  static constexpr size_t MAX_POLL_RATES = 32;
+
+  // The reads of every rate in due_mask, merged into as few requests as they fit
+  struct CyclePlan {
+    uint32_t due_mask{0};
+    uint32_t last_used{0};  // cycle_count_ when last polled, for eviction
+    std::vector<PollGroup> groups;
   };
-  std::vector<PollGroup> poll_groups_;
+  // A fixed number of plans. When every mask of due rates fits they are all planned with the
+  // rates; beyond that the least recently used plan is replaced by the one needed.
+  static constexpr size_t MAX_CYCLE_PLANS = 8;
+  std::vector<CyclePlan> cycle_plans_;
+  uint32_t cycle_count_{0};
+  const std::vector<PollGroup> &cycle_plan_(uint32_t due_mask);
+  void plan_cycle_(CyclePlan &plan);
+  std::vector<uint16_t> pairs_;  // First words of 32-bit values, kept in the same request as the second
+  const std::vector<PollGroup> *poll_groups_{nullptr};
   uint8_t current_poll_group_{0};
+  const PollGroup &cycle_group_() const { return (*this->poll_groups_)[this->current_poll_group_]; }
+  bool poll_groups_dirty_{false};
+  size_t polled_register_count_{0};
+  size_t available_register_count_{0};
+
+  // Read in flight (nullptr while a write is pending) and the group used for setup reads
+  const PollGroup *active_group_{nullptr};
+  uint8_t current_page_{0};
+  PollGroup setup_group_;
 
-  // Track which addresses we expect in the current response
-  std::vector<uint16_t> expected_addresses_;
+  // Fault isolation: a group the controller keeps rejecting is bisected, one probe at a time
+  // between cycles, and the registers it rejects on their own are left out of the plan
+  void on_group_rejected_(const PollGroup &group);
+  void send_probe_();
+  void on_probe_result_(bool accepted);
+  static constexpr uint8_t BISECT_AFTER_REJECTIONS = 3;
+  RangeBisector bisector_;
+  PollGroup probe_group_;
+  std::vector<uint16_t> excluded_registers_;  // Sorted
 
   // System detection results
   bool has_thermostat_{false};
@@ -113,30 +270,126 @@ class WaterFurnace : public PollingComponent, public uart::UARTDevice {
   std::string serial_number_;
   std::string abc_program_;
 
-  // Register cache
-  std::map<uint16_t, uint16_t> registers_;
+  // System ID and detection results kept in flash, so a reboot polls straight away and only
+  // checks the system ID once the first cycle is in
+  struct SetupCache {
+    uint32_t version;
+    char abc_program[9];
+    char model_number[25];
+    char serial_number[11];
+    bool has_thermostat;
+    bool has_axb;
+    bool has_iz2;
+    bool has_aoc;
+    bool has_moc;
+    bool has_vs_drive;
+    bool has_energy_monitoring;
+    bool awl_thermostat;
+    bool awl_axb;
+    bool awl_iz2;
+    uint8_t iz2_zone_count;
+    uint8_t excluded_count;
+    uint16_t excluded[16];
+  };
+  static constexpr uint32_t SETUP_CACHE_VERSION = 1;
+  bool load_setup_cache_();
+  void save_setup_cache_();
+  SetupCache setup_snapshot_() const;  // Current detection, as it would be saved
+  // Same unit and boards; excluded registers are not compared
+  static bool same_detection_(const SetupCache &a, const SetupCache &b);
+  void on_system_id_verified_();
+  ESPPreferenceObject setup_cache_pref_;
+  bool setup_from_cache_{false};  // Cache loaded, setup not yet finished from it
+  bool verify_system_id_{false};  // Setup came from the cache, system ID still unchecked
+  bool detection_changed_{false};  // The verify read found a different unit or boards
+
+  // Register cache, slots assigned with the poll plan
+  RegisterCache registers_;
+  uint32_t force_publish_interval_{300000};
 
   // Listeners
-  std::vector<RegisterListener> listeners_;
+  ListenerTable listeners_;
+  std::vector<DiagnosticListener> diagnostic_listeners_;
 
-  // Write queue
-  std::vector<std::pair<uint16_t, uint16_t>> pending_writes_;
+  // Adaptive polling (intervals in ms)
+  bool adaptive_polling_{false};
+  uint32_t idle_interval_{60000};
+  uint32_t running_interval_{10000};
+  uint32_t transition_interval_{2000};
+  uint32_t transition_duration_{180000};
+  PollingMode polling_mode_{PollingMode::FIXED};
+  uint32_t equipment_state_{0};
+  bool has_equipment_state_{false};
+  uint32_t last_state_change_{0};
+
+  // Write queue, sent ahead of the next poll group
+  WriteQueue pending_writes_;
+  uint32_t write_latency_max_{0};
+
+  // Read-back of written registers, sent as soon as the write is answered
+  std::vector<std::pair<uint16_t, uint16_t>> readback_registers_;  // (write address, address read back)
+  std::vector<uint16_t> readback_pending_;                         // Sorted
+  uint32_t readback_write_time_{0};                                // When the write being confirmed went out
+  PollGroup readback_group_;
 
   // Hardware
   GPIOPin *flow_control_pin_{nullptr};
+  // Held while a frame is going out, so the bus is released close to when it is done
+  HighFrequencyLoopRequester high_freq_;
+  uint32_t tx_done_us_{0};  // When the frame being sent has left the UART
+
+  // Bus task: the exchange runs on another core and hands over whole results
+  static constexpr uint8_t BUS_TASK_CORE = 0;  // The main loop runs on core 1
+  static constexpr uint32_t BUS_TASK_GRACE = 100;  // ms past the response timeout before giving up on the task
+  bool bus_task_{false};
+  std::unique_ptr<BusPort> bus_port_;
+  std::unique_ptr<BusWorker> bus_worker_;
+  BusRequest bus_request_;
+  BusResult bus_result_;
 
   // Timing
+  BusTiming bus_timing_;  // From the UART settings
+  uint32_t setup_time_{0};
+  uint32_t startup_time_{0};    // setup() to first dispatch (ms)
+  bool first_dispatch_{false};
   uint32_t last_request_time_{0};
   uint32_t last_response_time_{0};
   uint32_t error_backoff_until_{0};
 
-  // UART receive buffer
-  std::vector<uint8_t> rx_buffer_;
+  // Request in flight, kept for its one retry, and what it expects back
+  const uint8_t *request_{nullptr};
+  size_t request_len_{0};
+  Transaction transaction_;
+  uint32_t stale_responses_{0};
+  uint32_t response_timeout_{RESPONSE_TIMEOUT};  // ms, for the request in flight
+  bool retried_{false};
+  uint8_t consecutive_failures_{0};
+
+  // Measured read turnaround and the limit derived from it (us)
+  RttTracker turnaround_;
+  uint32_t turnaround_limit_us_{RESPONSE_TIMEOUT * 1000};
+
+  // UART receive ring and frame assembly, the last complete frame taken from it, and the
+  // write request buffer. Fixed size so polling never touches the heap.
+  FrameAssembler rx_;
+  uint32_t rx_crc_errors_{0};        // Last crc_errors() reported
+  uint32_t rx_skipped_bytes_{0};     // Last skipped_bytes() reported
+  uint32_t rx_malformed_frames_{0};  // Last malformed_frames() reported
+  uint32_t rx_length_frames_{0};     // Last length_frames() and idle_frames() published
+  uint32_t rx_idle_frames_{0};
+  uint32_t rx_idle_timeout_{20000};  // Configured end-of-frame silence (us)
+  uint32_t rx_idle_us_{20000};       // Effective: the longer of the above and t3.5
+  uint32_t rx_last_byte_us_{0};      // When bytes were last seen arriving
+  uint8_t rx_frame_[MAX_FRAME_SIZE];
+  uint8_t tx_frame_[MAX_FRAME_SIZE];
 
-  // Response timeout (ms)
+  // Response timeout (ms): used until read turnaround has been measured, and for writes
   static constexpr uint32_t RESPONSE_TIMEOUT = 2000;
-  // Error backoff time (ms)
-  static constexpr uint32_t ERROR_BACKOFF_TIME = 5000;
+  // Least turnaround a read is allowed once measured (ms)
+  static constexpr uint32_t MIN_RESPONSE_TIMEOUT = 100;
+  // Error backoff (ms), doubled for each consecutive failure up to the cap
+  static constexpr uint32_t ERROR_BACKOFF_MIN = 1000;
+  static constexpr uint32_t ERROR_BACKOFF_MAX = 60000;
   // Inter-frame delay for ModBus RTU at 19200 baud (1.75ms minimum, use 5ms for safety)
   static constexpr uint32_t INTER_FRAME_DELAY = 5;
 };
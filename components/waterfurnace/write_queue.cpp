@@ -0,0 +1,67 @@
+#include "write_queue.h"
+#include "registers.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace waterfurnace {
+
+bool WriteQueue::set(uint16_t address, uint16_t value, uint32_t now) {
+  for (auto &entry : this->entries_) {
+    if (entry.address == address) {
+      // Keeps its place in line and the time the first write to it was queued
+      entry.value = value;
+      this->coalesced_++;
+      return true;
+    }
+  }
+  uint8_t rank = write_rank(address);
+  // After every entry of the same or a lower rank
+  auto it = std::find_if(this->entries_.begin(), this->entries_.end(),
+                         [rank](const Entry &entry) { return entry.rank > rank; });
+  this->entries_.insert(it, {address, value, rank, now});
+  return false;
+}
+
+uint32_t WriteQueue::oldest() const {
+  if (this->entries_.empty())
+    return 0;
+  // Rank ordering means the oldest entry is not necessarily the first
+  uint32_t oldest = this->entries_.front().queued;
+  for (const auto &entry : this->entries_) {
+    if (static_cast<int32_t>(entry.queued - oldest) < 0)
+      oldest = entry.queued;
+  }
+  return oldest;
+}
+
+std::vector<std::pair<uint16_t, uint16_t>> WriteQueue::take(size_t max) {
+  size_t n = std::min(max, this->entries_.size());
+  std::vector<std::pair<uint16_t, uint16_t>> batch;
+  batch.reserve(n);
+  for (size_t i = 0; i < n; i++)
+    batch.push_back({this->entries_[i].address, this->entries_[i].value});
+  this->entries_.erase(this->entries_.begin(), this->entries_.begin() + n);
+  return batch;
+}
+
+uint8_t WriteQueue::write_rank(uint16_t address) {
+  switch (address) {
+    case REG_WRITE_MODE:
+    case REG_WRITE_FAN_MODE:
+    case REG_DHW_ENABLE:
+      return 0;
+    default:
+      break;
+  }
+  // IntelliZone 2: 9 write registers per zone, mode at +0 and fan mode at +3
+  if (address >= REG_IZ2_WRITE_BASE && address < REG_IZ2_WRITE_BASE + IZ2_MAX_ZONES * 9) {
+    uint16_t offset = (address - REG_IZ2_WRITE_BASE) % 9;
+    if (offset == 0 || offset == 3)
+      return 0;
+  }
+  return 1;
+}
+
+}  // namespace waterfurnace
+}  // namespace esphome
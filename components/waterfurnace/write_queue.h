@@ -0,0 +1,55 @@
+#pragma once
+
+#include "protocol.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace waterfurnace {
+
+/// Most registers one func 67 request can carry: slave + func + (addr, value) pairs + CRC
+static constexpr size_t MAX_WRITES_PER_REQUEST = (MAX_FRAME_SIZE - 4) / 4;
+
+/// Pending register writes, at most one per address.
+/// Writing an address that is already queued replaces its value in place (last writer wins),
+/// so dragging a slider sends only where it stopped. Batches come out ordered by write_rank()
+/// first and queueing order second, so a mode change always reaches the controller before the
+/// setpoints that depend on it, including when the queue is split across several requests.
+class WriteQueue {
+ public:
+  /// Queue a write at time now (ms). Returns true if it replaced a queued value.
+  bool set(uint16_t address, uint16_t value, uint32_t now);
+
+  bool empty() const { return this->entries_.empty(); }
+  size_t size() const { return this->entries_.size(); }
+  void clear() { this->entries_.clear(); }
+
+  /// When the longest-waiting write was queued (ms); 0 if empty
+  uint32_t oldest() const;
+
+  /// Remove up to max writes from the front of the queue, in send order
+  std::vector<std::pair<uint16_t, uint16_t>> take(size_t max = MAX_WRITES_PER_REQUEST);
+
+  /// Writes dropped because a later value for the same address replaced them
+  uint32_t coalesced() const { return this->coalesced_; }
+
+  /// Send order class of an address: modes (0) go before setpoints and everything else (1)
+  static uint8_t write_rank(uint16_t address);
+
+ protected:
+  struct Entry {
+    uint16_t address;
+    uint16_t value;
+    uint8_t rank;
+    uint32_t queued;
+  };
+
+  std::vector<Entry> entries_;  // In send order
+  uint32_t coalesced_{0};
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -0,0 +1,255 @@
+// Host benchmarks for the hub's hot paths
+// Compile: g++ -std=c++17 -O2 -Ishim -I../components/waterfurnace -o benchmark benchmark.cpp shim/shim.cpp ../components/waterfurnace/*.cpp ../components/waterfurnace/*/*.cpp -pthread
+// Run: ./benchmark (from tests/, the hub benchmark loads fixtures/sample_registers.yml)
+
+#include "bus_worker.h"
+#include "fake_aurora.h"
+#include "frame_assembler.h"
+#include "listener_table.h"
+#include "protocol.h"
+#include "shim.h"
+#include "spsc_ring.h"
+#include "waterfurnace.h"
+#include "sensor/waterfurnace_sensor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::waterfurnace;
+
+using Clock = std::chrono::steady_clock;
+
+static volatile uint32_t sink = 0;
+
+// Run fn repeatedly for roughly 200ms and return the mean time per call in ns
+template<typename F> static double time_ns(F &&fn) {
+  uint32_t iterations = 0;
+  auto start = Clock::now();
+  auto elapsed = Clock::duration::zero();
+  do {
+    for (int i = 0; i < 100; i++)
+      fn();
+    iterations += 100;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+  return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+// ====== Listener Dispatch ======
+
+// One 100-register response with 20 listeners inside it; the remaining listeners watch
+// registers polled by other groups, as IZ2 zones and extra sensors would
+static void bench_listener_dispatch() {
+  static constexpr uint16_t RESPONSE_BASE = 1100;
+  static constexpr uint16_t RESPONSE_SIZE = 100;
+  static constexpr size_t IN_RESPONSE = 20;
+
+  std::vector<uint16_t> response;
+  for (uint16_t i = 0; i < RESPONSE_SIZE; i++)
+    response.push_back(RESPONSE_BASE + i);
+  std::vector<uint16_t> values(RESPONSE_SIZE, 42);
+
+  printf("Listener dispatch (100-register response, %u listeners in it):\n", static_cast<unsigned>(IN_RESPONSE));
+  printf("  %10s %16s %16s\n", "listeners", "linear ns/resp", "indexed ns/resp");
+
+  for (size_t total : {20, 50, 100, 200, 500}) {
+    ListenerTable table;
+    std::vector<RegisterListener> linear;
+    for (size_t i = 0; i < total; i++) {
+      uint16_t address = i < IN_RESPONSE ? RESPONSE_BASE + i * (RESPONSE_SIZE / IN_RESPONSE)
+                                         : static_cast<uint16_t>(12000 + i);
+      RegisterListener listener{address, [](uint16_t v) { sink = sink + v; }};
+      linear.push_back(listener);
+      table.add(listener);
+    }
+    table.freeze();
+    auto spans = table.resolve(response);
+
+    double linear_ns = time_ns([&]() {
+      for (size_t i = 0; i < response.size(); i++) {
+        for (auto &listener : linear) {
+          if (listener.address == response[i])
+            listener.callback(values[i]);
+        }
+      }
+    });
+    double indexed_ns = time_ns([&]() {
+      for (size_t i = 0; i < response.size(); i++) {
+        for (uint16_t l = spans[i].begin; l < spans[i].end; l++)
+          table[l].callback(values[i]);
+      }
+    });
+    printf("  %10u %16.0f %16.0f\n", static_cast<unsigned>(total), linear_ns, indexed_ns);
+  }
+}
+
+// ====== CRC16 ======
+
+// Largest response we poll (100 registers) and a typical request
+static void bench_crc16() {
+  printf("\nCRC16 throughput:\n");
+  printf("  %10s %10s %10s %10s\n", "variant", "bytes", "ns/frame", "bytes/ns");
+
+  uint8_t frame[205];
+  uint32_t seed = 1;
+  for (auto &b : frame) {
+    seed = seed * 1103515245 + 12345;
+    b = seed >> 16;
+  }
+
+  struct Variant {
+    const char *name;
+    uint16_t (*fn)(const uint8_t *, size_t);
+  };
+  const Variant variants[] = {{"bitwise", crc16_bitwise}, {"table", crc16_table}, {"slice4", crc16_slice4}};
+  for (size_t len : {sizeof(frame), size_t(28)}) {
+    for (const auto &variant : variants) {
+      double ns = time_ns([&]() { sink = sink + variant.fn(frame, len); });
+      printf("  %10s %10u %10.0f %10.3f\n", variant.name, static_cast<unsigned>(len), ns, len / ns);
+    }
+  }
+}
+
+// ====== Frame Assembly ======
+
+// A 205-byte response trickling in: cost of one loop() pass over each new chunk
+static void bench_frame_assembly() {
+  printf("\nFrame assembly (205-byte response):\n");
+  printf("  %10s %14s %14s\n", "chunk", "ns/poll", "ns/frame");
+
+  uint8_t response[205];
+  response[0] = SLAVE_ADDRESS;
+  response[1] = FUNC_READ_RANGES;
+  response[2] = 200;
+  for (size_t i = 3; i < 203; i++)
+    response[i] = i;
+  uint16_t crc = crc16(response, 203);
+  response[203] = crc & 0xFF;
+  response[204] = crc >> 8;
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  for (size_t chunk : {1, 8, 64}) {
+    size_t polls = (sizeof(response) + chunk - 1) / chunk;
+    double ns = time_ns([&]() {
+      for (size_t off = 0; off < sizeof(response); off += chunk) {
+        rx.write(response + off, std::min(chunk, sizeof(response) - off));
+        sink = sink + rx.poll(frame);
+      }
+    });
+    printf("  %10u %14.1f %14.0f\n", static_cast<unsigned>(chunk), ns / polls, ns);
+  }
+}
+
+// ====== Bus Task Handoff ======
+
+// Cost of passing one decoded result through the SPSC ring between the bus task and the main
+// loop: a push and a pop, without the cross-core cache traffic a real handoff adds
+static void bench_bus_handoff() {
+  printf("\nBus task handoff (BusResult, %u bytes):\n", static_cast<unsigned>(sizeof(BusResult)));
+  SpscRing<BusResult, BusWorker::QUEUE_SIZE> ring;
+  BusResult in, out;
+  double ns = time_ns([&]() {
+    in.id++;
+    ring.push(in);
+    ring.pop(out);
+    sink = sink + out.id;
+  });
+  printf("  %14.1f ns/result\n", ns);
+}
+
+// ====== Hub Poll Cycle ======
+
+class BenchHub : public WaterFurnace {
+ public:
+  bool idle() const { return this->state_ == State::IDLE; }
+};
+
+// The real hub on the shim's fake UART with the sample unit behind it: bus time and loop()
+// passes per poll cycle, and the host cost of a loop() pass while idle and during a cycle
+static void bench_hub_cycle() {
+  static constexpr uint16_t SENSOR_REGISTERS[] = {16,   740,  741,  742,  747,  900,  1105, 1107,
+                                                  1110, 1111, 1113, 1114, 1115, 1116, 1117, 1119};
+  static constexpr uint16_t POWER_REGISTERS[] = {1146, 1148, 1150, 1152};
+  static constexpr uint32_t CYCLES = 20;
+
+  shim::reset();
+  FakeAurora aurora;
+  if (!aurora.load("fixtures/sample_registers.yml")) {
+    printf("\nHub poll cycle: skipped, run from tests/ for fixtures/sample_registers.yml\n");
+    return;
+  }
+  shim::FakeUart uart;
+  uart.responder = [&aurora](const uint8_t *request, size_t len) { return aurora.respond(request, len); };
+  BenchHub hub;
+  hub.set_uart_parent(&uart);
+  shim::Runner runner;
+  runner.add(&hub);
+  std::vector<std::unique_ptr<WaterFurnaceSensor>> sensors;
+  auto add_sensor = [&](uint16_t addr, bool is_32bit) {
+    sensors.emplace_back(new WaterFurnaceSensor());
+    sensors.back()->set_parent(&hub);
+    sensors.back()->set_register_address(addr);
+    sensors.back()->set_register_type(is_32bit ? "uint32" : "signed_tenths");
+    sensors.back()->set_is_32bit(is_32bit);
+    runner.add(sensors.back().get());
+  };
+  for (uint16_t addr : SENSOR_REGISTERS)
+    add_sensor(addr, false);
+  for (uint16_t addr : POWER_REGISTERS)
+    add_sensor(addr, true);
+  runner.setup();
+  runner.run_for(2 * hub.get_update_interval());  // Setup and every plan built
+
+  uint32_t requests = 0, bus_us = 0, cycle_passes = 0, idle_passes = 0;
+  double cycle_ns = 0, idle_ns = 0;
+  for (uint32_t cycle = 0; cycle < CYCLES;) {
+    bool was_idle = hub.idle();
+    size_t written = uart.requests.size();
+    hub.call_poller(millis());
+    auto start = Clock::now();
+    hub.loop();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    if (was_idle && uart.requests.size() == written) {
+      idle_ns += ns;
+      idle_passes++;
+    } else {
+      cycle_ns += ns;
+      cycle_passes++;
+      if (was_idle)
+        bus_us -= shim::now_us();  // Cycle starts with this pass
+      if (hub.idle()) {
+        bus_us += shim::now_us();
+        cycle++;
+      }
+    }
+    requests += uart.requests.size() - written;
+    shim::advance_us(HighFrequencyLoopRequester::is_high_frequency() ? runner.high_freq_tick_us
+                                                                     : runner.loop_interval_ms * 1000);
+  }
+
+  printf("\nHub poll cycle (sample unit, %u sensors, %u cycles):\n", static_cast<unsigned>(sensors.size()), CYCLES);
+  printf("  %14s %14s %14s %14s %14s\n", "requests", "bus ms", "loop passes", "ns/loop idle", "ns/loop busy");
+  printf("  %14.1f %14.1f %14.1f %14.1f %14.1f\n", static_cast<double>(requests) / CYCLES,
+         bus_us / 1000.0 / CYCLES, static_cast<double>(cycle_passes) / CYCLES, idle_ns / idle_passes,
+         cycle_ns / cycle_passes);
+}
+
+// ====== Main ======
+
+int main() {
+  printf("WaterFurnace Host Benchmarks\n");
+  printf("============================\n\n");
+
+  bench_listener_dispatch();
+  bench_crc16();
+  bench_frame_assembly();
+  bench_bus_handoff();
+  bench_hub_cycle();
+
+  return 0;
+}
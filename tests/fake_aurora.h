@@ -0,0 +1,110 @@
+#pragma once
+
+// Stand-in for the Aurora ABC board on the other end of the UART, for the host tests and
+// benchmarks that drive the hub through the shim
+
+#include "protocol.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace waterfurnace {
+
+// Answers func 65/66/67 requests from a register map, like the ABC board would
+class FakeAurora {
+ public:
+  // "address: value  # comment" lines, as in fixtures/sample_registers.yml
+  bool load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+      return false;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+      unsigned addr;
+      int value;
+      if (sscanf(line, "%u: %d", &addr, &value) == 2)
+        this->registers[addr] = static_cast<uint16_t>(value);
+    }
+    fclose(file);
+    return true;
+  }
+
+  std::vector<uint8_t> respond(const uint8_t *request, size_t len) {
+    this->requests++;
+    if (len < MIN_FRAME_SIZE || !validate_frame_crc(request, len))
+      return {};
+    if (this->drop > 0) {
+      this->drop--;
+      return {};
+    }
+    uint8_t func = request[1];
+    const uint8_t *payload = request + 2;
+    size_t payload_len = len - 4;
+    std::vector<uint16_t> addresses;
+    if (func == FUNC_READ_RANGES) {
+      for (size_t i = 0; i + 4 <= payload_len; i += 4) {
+        uint16_t start = payload[i] << 8 | payload[i + 1];
+        uint16_t count = payload[i + 2] << 8 | payload[i + 3];
+        for (uint16_t j = 0; j < count; j++)
+          addresses.push_back(start + j);
+      }
+    } else if (func == FUNC_READ_REGISTERS) {
+      for (size_t i = 0; i + 2 <= payload_len; i += 2)
+        addresses.push_back(payload[i] << 8 | payload[i + 1]);
+    } else if (func == FUNC_WRITE_REGISTERS) {
+      for (size_t i = 0; i + 4 <= payload_len; i += 4) {
+        uint16_t addr = payload[i] << 8 | payload[i + 1];
+        uint16_t value = payload[i + 2] << 8 | payload[i + 3];
+        this->writes.emplace_back(addr, value);
+        auto mirror = this->mirrors.find(addr);
+        this->registers[mirror != this->mirrors.end() ? mirror->second : addr] = value;
+      }
+      return finish({SLAVE_ADDRESS, func});
+    } else {
+      return finish({SLAVE_ADDRESS, static_cast<uint8_t>(func | ERROR_MASK), 0x01});
+    }
+
+    for (uint16_t addr : addresses) {
+      if (this->rejected.count(addr))
+        return finish({SLAVE_ADDRESS, static_cast<uint8_t>(func | ERROR_MASK), 0x02});
+    }
+    this->reads++;
+    std::vector<uint8_t> response = {SLAVE_ADDRESS, func, static_cast<uint8_t>(addresses.size() * 2)};
+    if (this->miscount > 0 && !addresses.empty()) {
+      this->miscount--;
+      response[2] -= 2;
+    }
+    for (uint16_t addr : addresses) {
+      auto it = this->registers.find(addr);
+      uint16_t value = it != this->registers.end() ? it->second : 0;
+      response.push_back(value >> 8);
+      response.push_back(value & 0xFF);
+    }
+    return finish(std::move(response));
+  }
+
+  std::map<uint16_t, uint16_t> registers;
+  std::map<uint16_t, uint16_t> mirrors;  // Write address -> register the write shows up in
+  std::set<uint16_t> rejected;           // Reads covering these get an exception
+  uint32_t drop{0};                      // Leave this many requests unanswered
+  uint32_t miscount{0};                  // Answer this many reads with a byte count one value short
+  uint32_t requests{0};
+  uint32_t reads{0};                     // Reads answered with data
+  std::vector<std::pair<uint16_t, uint16_t>> writes;
+
+ protected:
+  static std::vector<uint8_t> finish(std::vector<uint8_t> frame) {
+    uint16_t crc = crc16(frame.data(), frame.size());
+    frame.push_back(crc & 0xFF);
+    frame.push_back(crc >> 8);
+    return frame;
+  }
+};
+
+}  // namespace waterfurnace
+}  // namespace esphome
@@ -33,9 +33,40 @@ run_test "Unit tests" bash -c '
   g++ -std=c++17 -I../components/waterfurnace \
     -o test_protocol test_protocol.cpp \
     ../components/waterfurnace/protocol.cpp \
+    ../components/waterfurnace/poll_planner.cpp \
+    ../components/waterfurnace/listener_table.cpp \
+    ../components/waterfurnace/register_cache.cpp \
+    ../components/waterfurnace/frame_assembler.cpp \
+    ../components/waterfurnace/range_bisector.cpp \
+    ../components/waterfurnace/rtt_tracker.cpp \
+    ../components/waterfurnace/write_queue.cpp \
+    ../components/waterfurnace/bus_worker.cpp \
+    -pthread \
   && ./test_protocol
 '
 
+# Hub tests (the real hub and entities on the ESPHome shim)
+run_test "Hub tests" bash -c '
+  cd tests
+  g++ -std=c++17 -Ishim -I../components/waterfurnace \
+    -o test_hub test_hub.cpp shim/shim.cpp \
+    ../components/waterfurnace/*.cpp \
+    ../components/waterfurnace/*/*.cpp \
+    -pthread \
+  && ./test_hub
+'
+
+# Benchmarks (informational, fails only if the build fails)
+run_test "Benchmarks" bash -c '
+  cd tests
+  g++ -std=c++17 -O2 -Ishim -I../components/waterfurnace \
+    -o benchmark benchmark.cpp shim/shim.cpp \
+    ../components/waterfurnace/*.cpp \
+    ../components/waterfurnace/*/*.cpp \
+    -pthread \
+  && ./benchmark
+'
+
 # Integration tests
 run_test "Integration tests" bash -c '
   cd tests
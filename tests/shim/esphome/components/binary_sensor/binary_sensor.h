@@ -0,0 +1,28 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+#include <cstdint>
+
+// Host shim: publishes are recorded instead of sent anywhere
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor : public EntityBase {
+ public:
+  void publish_state(bool state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+  }
+  bool has_state() const { return this->has_state_; }
+
+  bool state{false};
+  uint32_t publish_count{0};
+
+ protected:
+  bool has_state_{false};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
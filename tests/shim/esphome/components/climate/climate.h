@@ -0,0 +1,149 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+// Host shim: the subset of the climate API the component uses. Publishes are recorded
+// instead of sent anywhere; make_call().perform() hands the call to control().
+namespace esphome {
+namespace climate {
+
+enum ClimateMode : uint8_t {
+  CLIMATE_MODE_OFF = 0,
+  CLIMATE_MODE_HEAT_COOL = 1,
+  CLIMATE_MODE_COOL = 2,
+  CLIMATE_MODE_HEAT = 3,
+  CLIMATE_MODE_FAN_ONLY = 4,
+  CLIMATE_MODE_DRY = 5,
+  CLIMATE_MODE_AUTO = 6,
+};
+
+enum ClimateFanMode : uint8_t {
+  CLIMATE_FAN_ON = 0,
+  CLIMATE_FAN_OFF = 1,
+  CLIMATE_FAN_AUTO = 2,
+};
+
+enum ClimatePreset : uint8_t {
+  CLIMATE_PRESET_NONE = 0,
+  CLIMATE_PRESET_HOME = 1,
+  CLIMATE_PRESET_AWAY = 2,
+  CLIMATE_PRESET_BOOST = 3,
+};
+
+class ClimateTraits {
+ public:
+  void set_supports_current_temperature(bool supports) { this->supports_current_temperature_ = supports; }
+  void set_supports_two_point_target_temperature(bool supports) { this->supports_two_point_ = supports; }
+  void set_visual_min_temperature(float temperature) { this->visual_min_temperature_ = temperature; }
+  void set_visual_max_temperature(float temperature) { this->visual_max_temperature_ = temperature; }
+  void set_visual_temperature_step(float step) { this->visual_temperature_step_ = step; }
+  void set_supported_modes(std::set<ClimateMode> modes) { this->supported_modes_ = std::move(modes); }
+  void set_supported_fan_modes(std::set<ClimateFanMode> modes) { this->supported_fan_modes_ = std::move(modes); }
+  void set_supported_custom_fan_modes(std::set<std::string> modes) {
+    this->supported_custom_fan_modes_ = std::move(modes);
+  }
+  void set_supported_presets(std::set<ClimatePreset> presets) { this->supported_presets_ = std::move(presets); }
+
+  bool get_supports_current_temperature() const { return this->supports_current_temperature_; }
+  bool get_supports_two_point_target_temperature() const { return this->supports_two_point_; }
+  const std::set<ClimateMode> &get_supported_modes() const { return this->supported_modes_; }
+  const std::set<ClimateFanMode> &get_supported_fan_modes() const { return this->supported_fan_modes_; }
+  const std::set<std::string> &get_supported_custom_fan_modes() const { return this->supported_custom_fan_modes_; }
+  const std::set<ClimatePreset> &get_supported_presets() const { return this->supported_presets_; }
+
+ protected:
+  bool supports_current_temperature_{false};
+  bool supports_two_point_{false};
+  float visual_min_temperature_{10.0f};
+  float visual_max_temperature_{30.0f};
+  float visual_temperature_step_{0.1f};
+  std::set<ClimateMode> supported_modes_;
+  std::set<ClimateFanMode> supported_fan_modes_;
+  std::set<std::string> supported_custom_fan_modes_;
+  std::set<ClimatePreset> supported_presets_;
+};
+
+class Climate;
+
+class ClimateCall {
+ public:
+  explicit ClimateCall(Climate *parent) : parent_(parent) {}
+
+  ClimateCall &set_mode(ClimateMode mode) {
+    this->mode_ = mode;
+    return *this;
+  }
+  ClimateCall &set_target_temperature_low(float temperature) {
+    this->target_temperature_low_ = temperature;
+    return *this;
+  }
+  ClimateCall &set_target_temperature_high(float temperature) {
+    this->target_temperature_high_ = temperature;
+    return *this;
+  }
+  ClimateCall &set_fan_mode(ClimateFanMode fan_mode) {
+    this->fan_mode_ = fan_mode;
+    return *this;
+  }
+  ClimateCall &set_fan_mode(const std::string &custom_fan_mode) {
+    this->custom_fan_mode_ = custom_fan_mode;
+    return *this;
+  }
+  ClimateCall &set_preset(ClimatePreset preset) {
+    this->preset_ = preset;
+    return *this;
+  }
+  void perform();
+
+  const optional<ClimateMode> &get_mode() const { return this->mode_; }
+  const optional<float> &get_target_temperature_low() const { return this->target_temperature_low_; }
+  const optional<float> &get_target_temperature_high() const { return this->target_temperature_high_; }
+  const optional<ClimateFanMode> &get_fan_mode() const { return this->fan_mode_; }
+  bool has_custom_fan_mode() const { return this->custom_fan_mode_.has_value(); }
+  const std::string &get_custom_fan_mode() const { return *this->custom_fan_mode_; }
+  const optional<ClimatePreset> &get_preset() const { return this->preset_; }
+
+ protected:
+  Climate *parent_;
+  optional<ClimateMode> mode_;
+  optional<float> target_temperature_low_;
+  optional<float> target_temperature_high_;
+  optional<ClimateFanMode> fan_mode_;
+  optional<std::string> custom_fan_mode_;
+  optional<ClimatePreset> preset_;
+};
+
+class Climate : public EntityBase {
+ public:
+  virtual ~Climate() = default;
+  ClimateCall make_call() { return ClimateCall(this); }
+  void publish_state() { this->publish_count++; }
+  const optional<std::string> &get_custom_fan_mode() const { return this->custom_fan_mode_; }
+
+  ClimateMode mode{CLIMATE_MODE_OFF};
+  optional<ClimateFanMode> fan_mode;
+  optional<ClimatePreset> preset;
+  float current_temperature{0.0f};
+  float target_temperature_low{0.0f};
+  float target_temperature_high{0.0f};
+  uint32_t publish_count{0};
+
+ protected:
+  friend ClimateCall;
+  virtual ClimateTraits traits() = 0;
+  virtual void control(const ClimateCall &call) = 0;
+  void set_custom_fan_mode_(const char *mode) { this->custom_fan_mode_ = std::string(mode); }
+  void clear_custom_fan_mode_() { this->custom_fan_mode_.reset(); }
+
+  optional<std::string> custom_fan_mode_;
+};
+
+inline void ClimateCall::perform() { this->parent_->control(*this); }
+
+}  // namespace climate
+}  // namespace esphome
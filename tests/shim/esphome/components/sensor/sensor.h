@@ -0,0 +1,31 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+#include <cstdint>
+
+// Host shim: publishes are recorded instead of sent anywhere
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+  }
+  bool has_state() const { return this->has_state_; }
+  bool get_force_update() const { return this->force_update_; }
+  void set_force_update(bool force_update) { this->force_update_ = force_update; }
+
+  float state{0.0f};
+  uint32_t publish_count{0};
+
+ protected:
+  bool has_state_{false};
+  bool force_update_{false};
+};
+
+}  // namespace sensor
+}  // namespace esphome
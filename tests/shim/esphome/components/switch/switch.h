@@ -0,0 +1,29 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+#include <cstdint>
+
+// Host shim: publishes are recorded instead of sent anywhere
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase {
+ public:
+  virtual ~Switch() = default;
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count++;
+  }
+
+  bool state{false};
+  uint32_t publish_count{0};
+
+ protected:
+  virtual void write_state(bool state) = 0;
+};
+
+}  // namespace switch_
+}  // namespace esphome
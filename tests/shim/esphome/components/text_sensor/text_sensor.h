@@ -0,0 +1,29 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+#include <cstdint>
+#include <string>
+
+// Host shim: publishes are recorded instead of sent anywhere
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+ public:
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publish_count++;
+  }
+  bool has_state() const { return this->has_state_; }
+
+  std::string state;
+  uint32_t publish_count{0};
+
+ protected:
+  bool has_state_{false};
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
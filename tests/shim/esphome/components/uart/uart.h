@@ -0,0 +1,61 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Host shim: the UART bus is an interface; shim::FakeUart (shim.h) implements it on the
+// virtual clock
+namespace esphome {
+namespace uart {
+
+enum UARTParityOptions {
+  UART_CONFIG_PARITY_NONE,
+  UART_CONFIG_PARITY_EVEN,
+  UART_CONFIG_PARITY_ODD,
+};
+
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual bool peek_byte(uint8_t *data) = 0;
+  virtual bool read_array(uint8_t *data, size_t len) = 0;
+  virtual int available() = 0;
+  virtual void flush() = 0;
+
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+  uint8_t get_data_bits() const { return this->data_bits_; }
+  uint8_t get_stop_bits() const { return this->stop_bits_; }
+  UARTParityOptions get_parity() const { return this->parity_; }
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+  void set_data_bits(uint8_t data_bits) { this->data_bits_ = data_bits; }
+  void set_stop_bits(uint8_t stop_bits) { this->stop_bits_ = stop_bits; }
+  void set_parity(UARTParityOptions parity) { this->parity_ = parity; }
+
+ protected:
+  uint32_t baud_rate_{19200};
+  uint8_t data_bits_{8};
+  uint8_t stop_bits_{1};
+  UARTParityOptions parity_{UART_CONFIG_PARITY_EVEN};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+  void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  bool read_array(uint8_t *data, size_t len) { return this->parent_->read_array(data, len); }
+  bool peek_byte(uint8_t *data) { return this->parent_->peek_byte(data); }
+  int available() { return this->parent_->available(); }
+  void flush() { this->parent_->flush(); }
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
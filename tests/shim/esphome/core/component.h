@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esphome/core/hal.h"
+
+#include <cstdint>
+#include <string>
+
+// Host shim: components are driven by shim::Runner (see shim.h) instead of App
+namespace esphome {
+
+namespace setup_priority {
+static constexpr float BUS = 1000.0f;
+static constexpr float IO = 900.0f;
+static constexpr float HARDWARE = 800.0f;
+static constexpr float DATA = 600.0f;
+static constexpr float PROCESSOR = 400.0f;
+static constexpr float AFTER_CONNECTION = 100.0f;
+static constexpr float LATE = -100.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+};
+
+/// update() runs every update_interval ms, the first time on the first loop after setup
+class PollingComponent : public Component {
+ public:
+  PollingComponent() = default;
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+  virtual void update() = 0;
+  virtual void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  uint32_t get_update_interval() const { return this->update_interval_; }
+  void start_poller() {
+    this->poller_running_ = true;
+    this->poller_started_ = true;
+  }
+  void stop_poller() { this->poller_running_ = false; }
+
+  // For the runner: run update() if it is due at now (ms)
+  void call_poller(uint32_t now) {
+    if (!this->poller_running_ || this->update_interval_ == UINT32_MAX)
+      return;
+    if (this->poller_started_ || now - this->last_update_ >= this->update_interval_) {
+      this->poller_started_ = false;
+      this->last_update_ = now;
+      this->update();
+    }
+  }
+
+ protected:
+  uint32_t update_interval_{10000};
+  uint32_t last_update_{0};
+  bool poller_running_{false};
+  bool poller_started_{false};
+};
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void setup() {}
+  virtual void digital_write(bool value) = 0;
+  virtual bool digital_read() = 0;
+  virtual std::string dump_summary() const = 0;
+};
+
+/// Name and flags shared by every entity
+class EntityBase {
+ public:
+  const std::string &get_name() const { return this->name_; }
+  void set_name(const std::string &name) { this->name_ = name; }
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace esphome
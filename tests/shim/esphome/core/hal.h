@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Host shim: time comes from the virtual clock in shim.h
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+// Advances the virtual clock; nothing else runs meanwhile
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+}  // namespace esphome
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "esphome/core/hal.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Host shim: the helpers the component uses, with ESPHome's semantics
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+using std::nullopt;
+
+uint32_t fnv1_hash(const std::string &str);
+std::string format_hex_pretty(const uint8_t *data, size_t length);
+
+/// While started, the shim's runner steps the clock in short ticks instead of the loop interval
+class HighFrequencyLoopRequester {
+ public:
+  void start();
+  void stop();
+  static bool is_high_frequency();
+
+ protected:
+  bool started_{false};
+  static int num_requests;
+};
+
+}  // namespace esphome
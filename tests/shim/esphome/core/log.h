@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+
+// Host shim: messages at or below the level set with shim::set_log_level() are printed,
+// and every message is counted per level. Arguments of suppressed messages are never
+// evaluated, as on a device built with a lower log level.
+namespace esphome {
+
+static constexpr int ESPHOME_LOG_LEVEL_NONE = 0;
+static constexpr int ESPHOME_LOG_LEVEL_ERROR = 1;
+static constexpr int ESPHOME_LOG_LEVEL_WARN = 2;
+static constexpr int ESPHOME_LOG_LEVEL_INFO = 3;
+static constexpr int ESPHOME_LOG_LEVEL_CONFIG = 4;
+static constexpr int ESPHOME_LOG_LEVEL_DEBUG = 5;
+static constexpr int ESPHOME_LOG_LEVEL_VERBOSE = 6;
+
+namespace shim {
+extern int log_level;      // Printed up to this level
+extern int log_evaluated;  // Formatted (counted) up to this level
+void log_printf(int level, const char *tag, int line, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+}  // namespace shim
+
+}  // namespace esphome
+
+#define ESPHOME_SHIM_LOG(level, tag, ...) \
+  do { \
+    if ((level) <= ::esphome::shim::log_evaluated) \
+      ::esphome::shim::log_printf(level, tag, __LINE__, __VA_ARGS__); \
+  } while (0)
+
+#define ESP_LOGE(tag, ...) ESPHOME_SHIM_LOG(::esphome::ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ESPHOME_SHIM_LOG(::esphome::ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ESPHOME_SHIM_LOG(::esphome::ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ESPHOME_SHIM_LOG(::esphome::ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ESPHOME_SHIM_LOG(::esphome::ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ESPHOME_SHIM_LOG(::esphome::ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+
+#define LOG_PIN(prefix, pin) \
+  if ((pin) != nullptr) { \
+    ESP_LOGCONFIG(TAG, prefix "%s", (pin)->dump_summary().c_str()); \
+  }
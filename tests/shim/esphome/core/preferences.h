@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Host shim: preferences live in memory for the life of the process, so a test can
+// "reboot" by building a new hub; shim::reset() wipes them
+namespace esphome {
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(std::vector<uint8_t> *data) : data_(data) {}
+
+  template<typename T> bool save(const T *src) {
+    if (this->data_ == nullptr)
+      return false;
+    auto bytes = reinterpret_cast<const uint8_t *>(src);
+    this->data_->assign(bytes, bytes + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dest) {
+    if (this->data_ == nullptr || this->data_->size() != sizeof(T))
+      return false;
+    auto bytes = reinterpret_cast<uint8_t *>(dest);
+    std::copy(this->data_->begin(), this->data_->end(), bytes);
+    return true;
+  }
+
+ protected:
+  std::vector<uint8_t> *data_{nullptr};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool /*in_flash*/ = false) {
+    return ESPPreferenceObject(&this->storage_[type]);
+  }
+  void clear() { this->storage_.clear(); }
+
+ protected:
+  std::map<uint32_t, std::vector<uint8_t>> storage_;
+};
+
+extern ESPPreferences *global_preferences;
+
+}  // namespace esphome
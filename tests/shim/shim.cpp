@@ -0,0 +1,197 @@
+#include "shim.h"
+
+#include "esphome/core/hal.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace esphome {
+
+namespace {
+uint32_t clock_us = 0;
+uint32_t log_counts[ESPHOME_LOG_LEVEL_VERBOSE + 1] = {};
+ESPPreferences preferences;
+}  // namespace
+
+ESPPreferences *global_preferences = &preferences;
+
+uint32_t millis() { return clock_us / 1000; }
+uint32_t micros() { return clock_us; }
+void delay(uint32_t ms) { clock_us += ms * 1000; }
+void delayMicroseconds(uint32_t us) { clock_us += us; }
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= static_cast<uint8_t>(c);
+  }
+  return hash;
+}
+
+std::string format_hex_pretty(const uint8_t *data, size_t length) {
+  static const char *const HEX = "0123456789ABCDEF";
+  std::string ret;
+  for (size_t i = 0; i < length; i++) {
+    if (i > 0)
+      ret += '.';
+    ret += HEX[data[i] >> 4];
+    ret += HEX[data[i] & 0x0F];
+  }
+  if (length > 4)
+    ret += " (" + std::to_string(length) + ")";
+  return ret;
+}
+
+int HighFrequencyLoopRequester::num_requests = 0;
+
+void HighFrequencyLoopRequester::start() {
+  if (this->started_)
+    return;
+  num_requests++;
+  this->started_ = true;
+}
+
+void HighFrequencyLoopRequester::stop() {
+  if (!this->started_)
+    return;
+  num_requests--;
+  this->started_ = false;
+}
+
+bool HighFrequencyLoopRequester::is_high_frequency() { return num_requests > 0; }
+
+namespace shim {
+
+int log_level = ESPHOME_LOG_LEVEL_NONE;
+int log_evaluated = ESPHOME_LOG_LEVEL_DEBUG;  // ESPHome's default build level
+
+void log_printf(int level, const char *tag, int line, const char *format, ...) {
+  log_counts[level]++;
+  if (level > log_level)
+    return;
+  static const char LETTERS[] = "NEWICDV";
+  char message[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  printf("[%10.3f][%c][%s:%d]: %s\n", clock_us / 1000.0, LETTERS[level], tag, line, message);
+}
+
+void reset() {
+  clock_us = 0;
+  std::fill(std::begin(log_counts), std::end(log_counts), 0);
+  preferences.clear();
+  const char *env = getenv("SHIM_LOG_LEVEL");
+  log_level = env != nullptr ? atoi(env) : ESPHOME_LOG_LEVEL_NONE;
+}
+
+uint32_t now_us() { return clock_us; }
+void advance_us(uint32_t us) { clock_us += us; }
+
+void set_log_level(int level) { log_level = level; }
+uint32_t log_count(int level) { return log_counts[level]; }
+
+void Runner::setup() {
+  std::stable_sort(this->components_.begin(), this->components_.end(), [](Component *a, Component *b) {
+    return a->get_setup_priority() > b->get_setup_priority();
+  });
+  for (auto *component : this->components_) {
+    component->setup();
+    if (auto *polling = dynamic_cast<PollingComponent *>(component))
+      polling->start_poller();
+  }
+  for (auto *component : this->components_)
+    component->dump_config();
+}
+
+void Runner::loop() {
+  uint32_t now = millis();
+  for (auto *component : this->components_) {
+    if (auto *polling = dynamic_cast<PollingComponent *>(component))
+      polling->call_poller(now);
+  }
+  for (auto *component : this->components_)
+    component->loop();
+  this->loops++;
+}
+
+void Runner::tick_() {
+  advance_us(HighFrequencyLoopRequester::is_high_frequency() ? this->high_freq_tick_us
+                                                             : this->loop_interval_ms * 1000);
+}
+
+void Runner::run_for(uint32_t ms) {
+  uint32_t end = clock_us + ms * 1000;
+  while (static_cast<int32_t>(clock_us - end) < 0) {
+    this->loop();
+    this->tick_();
+  }
+}
+
+bool Runner::run_until(const std::function<bool()> &done, uint32_t limit_ms) {
+  uint32_t end = clock_us + limit_ms * 1000;
+  while (static_cast<int32_t>(clock_us - end) < 0) {
+    this->loop();
+    if (done())
+      return true;
+    this->tick_();
+  }
+  return done();
+}
+
+uint32_t FakeUart::char_time_us() const {
+  uint32_t bits = 1 + this->data_bits_ + this->stop_bits_ + (this->parity_ != uart::UART_CONFIG_PARITY_NONE ? 1 : 0);
+  return (bits * 1000000 + this->baud_rate_ - 1) / this->baud_rate_;
+}
+
+void FakeUart::write_array(const uint8_t *data, size_t len) {
+  this->requests.emplace_back(data, data + len);
+  this->tx_end_us = clock_us + len * this->char_time_us();
+  if (this->tx_fifo_size > 0 && len > this->tx_fifo_size)
+    clock_us += (len - this->tx_fifo_size) * this->char_time_us();
+  if (!this->responder)
+    return;
+  std::vector<uint8_t> response = this->responder(data, len);
+  if (!response.empty())
+    this->inject(response, this->tx_end_us + this->turnaround_us);
+}
+
+void FakeUart::inject(const std::vector<uint8_t> &bytes, uint32_t at_us) {
+  uint32_t char_us = this->char_time_us();
+  for (size_t i = 0; i < bytes.size(); i++)
+    this->rx_.emplace_back(at_us + (i + 1) * char_us, bytes[i]);
+}
+
+int FakeUart::available() {
+  int n = 0;
+  for (const auto &byte : this->rx_) {
+    if (static_cast<int32_t>(clock_us - byte.first) < 0)
+      break;
+    n++;
+  }
+  return n;
+}
+
+bool FakeUart::peek_byte(uint8_t *data) {
+  if (this->available() == 0)
+    return false;
+  *data = this->rx_.front().second;
+  return true;
+}
+
+bool FakeUart::read_array(uint8_t *data, size_t len) {
+  if (static_cast<size_t>(this->available()) < len)
+    return false;
+  for (size_t i = 0; i < len; i++) {
+    data[i] = this->rx_.front().second;
+    this->rx_.pop_front();
+  }
+  return true;
+}
+
+}  // namespace shim
+}  // namespace esphome
@@ -0,0 +1,105 @@
+#pragma once
+
+// Host shim for the parts of ESPHome the component uses, so the hub and its entities build
+// and run on Linux. Time is virtual: it only moves when a test (or delay()) moves it, which
+// makes every run deterministic.
+
+#include "esphome/components/uart/uart.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace shim {
+
+/// Back to a clean slate: clock at zero, preferences and log counters wiped
+void reset();
+
+uint32_t now_us();
+void advance_us(uint32_t us);
+
+/// Print messages up to this level (default none; SHIM_LOG_LEVEL in the environment overrides)
+void set_log_level(int level);
+/// Messages logged at a level since reset(), printed or not
+uint32_t log_count(int level);
+
+/// Stands in for App: sets components up in priority order and runs loop() passes on the
+/// virtual clock
+class Runner {
+ public:
+  void add(Component *component) { this->components_.push_back(component); }
+  /// setup() by priority, highest first, then start every PollingComponent's poller
+  void setup();
+  /// One pass: due PollingComponent updates, then every component's loop()
+  void loop();
+  /// Loop for ms of virtual time. Passes are loop_interval_ms apart, or high_freq_tick_us
+  /// while a HighFrequencyLoopRequester is active, like the real main loop.
+  void run_for(uint32_t ms);
+  /// Loop until done() holds or limit_ms passes; true if done() held
+  bool run_until(const std::function<bool()> &done, uint32_t limit_ms);
+
+  uint32_t loop_interval_ms{16};
+  uint32_t high_freq_tick_us{200};
+  uint32_t loops{0};  // Passes run so far
+
+ protected:
+  void tick_();
+  std::vector<Component *> components_;
+};
+
+/// Output pin that remembers what was written
+class FakePin : public GPIOPin {
+ public:
+  void digital_write(bool value) override {
+    this->state = value;
+    this->writes++;
+    this->written_us = now_us();
+  }
+  bool digital_read() override { return this->state; }
+  std::string dump_summary() const override { return "fake"; }
+
+  bool state{false};
+  uint32_t writes{0};
+  uint32_t written_us{0};  // Time of the last write
+};
+
+/// UART on the virtual clock. Every write_array() is taken as one request frame: it is
+/// logged and handed to responder, and whatever the responder returns arrives byte by byte
+/// at the line rate, turnaround_us after the request has finished transmitting.
+class FakeUart : public uart::UARTComponent {
+ public:
+  using Responder = std::function<std::vector<uint8_t>(const uint8_t *request, size_t len)>;
+
+  void write_array(const uint8_t *data, size_t len) override;
+  bool peek_byte(uint8_t *data) override;
+  bool read_array(uint8_t *data, size_t len) override;
+  int available() override;
+  void flush() override {}
+
+  /// Bytes that arrive starting at at_us, one character time apart
+  void inject(const std::vector<uint8_t> &bytes, uint32_t at_us);
+  uint32_t char_time_us() const;
+
+  Responder responder;
+  uint32_t turnaround_us{20000};
+  // Nonzero: write_array() returns only once the bytes past this many are in the TX FIFO,
+  // like the ESP-IDF driver installed without a TX ring buffer
+  size_t tx_fifo_size{0};
+  std::vector<std::vector<uint8_t>> requests;  // Every frame written
+  uint32_t tx_end_us{0};                       // When the last frame finished transmitting
+
+ protected:
+  std::deque<std::pair<uint32_t, uint8_t>> rx_;  // (arrival, byte)
+};
+
+}  // namespace shim
+}  // namespace esphome
@@ -0,0 +1,571 @@
+// Host tests for the WaterFurnace hub and its entities, built against the ESPHome shim in
+// shim/ and driven on its virtual clock through a fake Aurora controller
+// Compile: g++ -std=c++17 -Ishim -I../components/waterfurnace -o test_hub test_hub.cpp shim/shim.cpp ../components/waterfurnace/*.cpp ../components/waterfurnace/*/*.cpp -pthread
+// Run: ./test_hub (from tests/, it loads fixtures/sample_registers.yml)
+
+#include "fake_aurora.h"
+#include "shim.h"
+
+#include "waterfurnace.h"
+#include "binary_sensor/waterfurnace_binary_sensor.h"
+#include "climate/waterfurnace_climate.h"
+#include "sensor/waterfurnace_sensor.h"
+#include "switch/waterfurnace_switch.h"
+#include "text_sensor/waterfurnace_text_sensor.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace esphome;
+using namespace esphome::waterfurnace;
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name()
+#define RUN(name) do { \
+    printf("  %-50s", #name); \
+    shim::reset(); \
+    try { test_##name(); tests_passed++; printf("PASS\n"); } \
+    catch (...) { tests_failed++; printf("FAIL\n"); } \
+  } while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    auto _a = (a); auto _b = (b); \
+    if (_a != _b) { \
+      printf("FAIL: %s == %s (%d != %d) at line %d\n", #a, #b, (int)_a, (int)_b, __LINE__); \
+      throw 1; \
+    } \
+  } while(0)
+
+#define ASSERT_FLOAT_EQ(a, b, eps) do { \
+    float _a = (a); float _b = (b); \
+    if (_a - _b > eps || _b - _a > eps) { \
+      printf("FAIL: %s == %s (%.4f != %.4f) at line %d\n", #a, #b, _a, _b, __LINE__); \
+      throw 1; \
+    } \
+  } while(0)
+
+#define ASSERT_TRUE(a) do { if (!(a)) { printf("FAIL: %s at line %d\n", #a, __LINE__); throw 1; } } while(0)
+#define ASSERT_FALSE(a) do { if (a) { printf("FAIL: !%s at line %d\n", #a, __LINE__); throw 1; } } while(0)
+
+// Heap allocations made while alloc_tracking is set
+static size_t alloc_count = 0;
+static bool alloc_tracking = false;
+
+void *operator new(size_t size) {
+  if (alloc_tracking)
+    alloc_count++;
+  void *ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+// The controller's side of the line is not the hub's cost: its allocations are not counted
+class HarnessUart : public shim::FakeUart {
+ public:
+  void write_array(const uint8_t *data, size_t len) override {
+    bool tracking = alloc_tracking;
+    alloc_tracking = false;
+    shim::FakeUart::write_array(data, len);
+    alloc_tracking = tracking;
+  }
+};
+
+// The hub with its state machine visible to the tests
+class TestHub : public WaterFurnace {
+ public:
+  bool setup_complete() const { return this->setup_complete_; }
+  bool idle() const { return this->state_ == State::IDLE; }
+  bool backing_off() const { return this->state_ == State::ERROR_BACKOFF; }
+  const std::vector<uint16_t> &excluded_registers() const { return this->excluded_registers_; }
+  uint32_t stale_responses() const { return this->stale_responses_; }
+  // Every rate due on the next tick, as after a rebuilt plan
+  void poll_all_rates() {
+    for (auto &rate : this->poll_rates_)
+      rate.due = true;
+  }
+
+  // A func 66 read of addresses, outside any poll cycle
+  void send_read(const std::vector<uint16_t> &addresses) {
+    this->read_group_ = PollGroup{};
+    this->read_group_.individual = addresses;
+    this->prepare_group_(this->read_group_);
+    this->send_group_(this->read_group_);
+  }
+
+ protected:
+  PollGroup read_group_;
+};
+
+// A hub on a fake UART with the sample unit behind it, and a few entities of each kind
+struct Rig {
+  explicit Rig(bool load_fixture = true) {
+    if (load_fixture && !this->aurora.load("fixtures/sample_registers.yml"))
+      printf("(fixtures/sample_registers.yml not found, run from tests/) ");
+    this->aurora.mirrors[REG_WRITE_HEATING_SP] = REG_HEATING_SETPOINT;
+    this->uart.responder = [this](const uint8_t *request, size_t len) { return this->aurora.respond(request, len); };
+    this->hub.set_uart_parent(&this->uart);
+    this->hub.set_flow_control_pin(&this->de);
+
+    this->leaving_water.set_name("Leaving Water");
+    this->leaving_water.set_parent(&this->hub);
+    this->leaving_water.set_register_address(1110);
+    this->leaving_water.set_register_type("signed_tenths");
+    this->total_power.set_name("Total Power");
+    this->total_power.set_parent(&this->hub);
+    this->total_power.set_register_address(1152);
+    this->total_power.set_register_type("uint32");
+    this->total_power.set_is_32bit(true);
+    this->compressor.set_name("Compressor");
+    this->compressor.set_parent(&this->hub);
+    this->compressor.set_register_address(REG_SYSTEM_OUTPUTS);
+    this->compressor.set_bitmask(OUTPUT_CC);
+    this->mode.set_name("Mode");
+    this->mode.set_parent(&this->hub);
+    this->mode.set_sensor_type("mode");
+    this->model.set_name("Model");
+    this->model.set_parent(&this->hub);
+    this->model.set_sensor_type("model");
+    this->dhw.set_name("DHW");
+    this->dhw.set_parent(&this->hub);
+    this->dhw.set_register_address(REG_DHW_ENABLE);
+    this->dhw.set_write_address(REG_DHW_ENABLE);
+    this->thermostat.set_name("Thermostat");
+    this->thermostat.set_parent(&this->hub);
+
+    for (Component *component : std::initializer_list<Component *>{
+             &this->hub, &this->leaving_water, &this->total_power, &this->compressor, &this->mode, &this->model,
+             &this->dhw, &this->thermostat})
+      this->runner.add(component);
+  }
+
+  // Set everything up and run until the first poll cycle is in
+  bool start(uint32_t limit_ms = 10000) {
+    this->runner.setup();
+    return this->runner.run_until(
+        [this]() { return this->hub.setup_complete() && this->leaving_water.has_state() && this->hub.idle(); },
+        limit_ms);
+  }
+
+  // Run until the hub has gone through another update(): its requests answered, or given up on
+  void run_cycle() {
+    uint32_t requests = this->aurora.requests;
+    this->runner.run_until([&]() { return this->aurora.requests != requests && this->hub.idle(); },
+                           this->hub.get_update_interval() * 2);
+  }
+
+  HarnessUart uart;
+  shim::FakePin de;
+  shim::Runner runner;
+  FakeAurora aurora;
+  TestHub hub;
+  WaterFurnaceSensor leaving_water;
+  WaterFurnaceSensor total_power;
+  WaterFurnaceBinarySensor compressor;
+  WaterFurnaceTextSensor mode;
+  WaterFurnaceTextSensor model;
+  WaterFurnaceSwitch dhw;
+  WaterFurnaceClimate thermostat;
+};
+
+// ====== Setup ======
+
+TEST(hub_detects_system) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  ASSERT_TRUE(rig.hub.model_number() == "OTP509");
+  ASSERT_TRUE(rig.hub.abc_program() == "ABCSPLVS");
+  ASSERT_TRUE(rig.hub.has_thermostat());
+  ASSERT_TRUE(rig.hub.has_axb());
+  ASSERT_FALSE(rig.hub.has_iz2());
+  ASSERT_TRUE(rig.hub.has_vs_drive());
+  ASSERT_TRUE(rig.hub.has_energy_monitoring());
+  ASSERT_EQ(shim::log_count(ESPHOME_LOG_LEVEL_WARN), 0u);
+}
+
+TEST(hub_publishes_entities) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  ASSERT_FLOAT_EQ(rig.leaving_water.state, 95.0f, 0.01f);
+  ASSERT_TRUE(rig.total_power.has_state());
+  ASSERT_TRUE(rig.compressor.state);
+  ASSERT_TRUE(rig.mode.state == "Heating");
+  ASSERT_TRUE(rig.model.state == rig.hub.model_number());
+  // Ambient 71.0°F, setpoints 68/75°F, published in °C
+  ASSERT_FLOAT_EQ(rig.thermostat.current_temperature, (71.0f - 32.0f) * 5.0f / 9.0f, 0.01f);
+  ASSERT_FLOAT_EQ(rig.thermostat.target_temperature_low, 20.0f, 0.01f);
+  ASSERT_TRUE(rig.thermostat.mode == climate::CLIMATE_MODE_HEAT_COOL);
+  // DE is driven for every request and released again
+  ASSERT_TRUE(rig.de.writes >= 2 * rig.uart.requests.size());
+  ASSERT_FALSE(rig.de.state);
+}
+
+TEST(hub_publishes_identity_on_first_boot) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  // Decoded before the setup read is dispatched: one publish, never an empty string
+  ASSERT_TRUE(rig.model.state == "OTP509");
+  ASSERT_EQ(rig.model.publish_count, 1u);
+}
+
+TEST(hub_boots_from_cached_setup) {
+  {
+    Rig first;
+    ASSERT_TRUE(first.start());
+  }
+  // Preferences survive the "reboot"; the clock keeps running
+  Rig rig;
+  rig.runner.setup();
+  ASSERT_TRUE(rig.hub.model_number() == "OTP509");
+  rig.runner.loop();
+  ASSERT_TRUE(rig.hub.setup_complete());
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.leaving_water.has_state(); }, 5000));
+}
+
+TEST(hub_verify_publishes_new_identity) {
+  {
+    Rig first;
+    ASSERT_TRUE(first.start());
+  }
+  // A different unit behind the same controller port: the cached identity is corrected
+  Rig rig;
+  rig.aurora.registers[94] = 0x3130;  // "10"
+  rig.runner.setup();
+  ASSERT_TRUE(rig.hub.model_number() == "OTP509");
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.model_number() == "OTP510"; }, 10000));
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.model.state == "OTP510"; }, 1000));
+}
+
+TEST(hub_verify_detects_added_board) {
+  {
+    Rig first;
+    ASSERT_TRUE(first.start());
+    ASSERT_FALSE(first.hub.has_iz2());
+  }
+  // Same unit, an IZ2 board fitted since the setup was cached
+  Rig rig;
+  rig.aurora.registers[REG_IZ2_STATUS] = COMPONENT_ADDED;
+  rig.runner.setup();
+  ASSERT_FALSE(rig.hub.has_iz2());
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.has_iz2(); }, 10000));
+  ASSERT_EQ(shim::log_count(ESPHOME_LOG_LEVEL_WARN), 1u);  // Detection changed
+}
+
+// ====== Polling ======
+
+TEST(hub_publishes_only_changes) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  uint32_t published = rig.leaving_water.publish_count;
+  rig.run_cycle();
+  rig.run_cycle();
+  ASSERT_EQ(rig.leaving_water.publish_count, published);
+
+  uint32_t switched = rig.dhw.publish_count;
+  rig.run_cycle();
+  ASSERT_EQ(rig.dhw.publish_count, switched);
+
+  rig.aurora.registers[1110] = 960;
+  rig.run_cycle();
+  ASSERT_EQ(rig.leaving_water.publish_count, published + 1);
+  ASSERT_FLOAT_EQ(rig.leaving_water.state, 96.0f, 0.01f);
+}
+
+TEST(hub_follows_update_interval) {
+  Rig rig;
+  rig.hub.set_update_interval(5000);
+  ASSERT_TRUE(rig.start());
+  uint32_t reads = rig.aurora.reads;
+  rig.runner.run_for(20000);
+  uint32_t cycles_reads = rig.aurora.reads - reads;
+  // Four updates in 20s, each the same number of reads
+  ASSERT_TRUE(cycles_reads > 0);
+  ASSERT_EQ(cycles_reads % 4, 0u);
+}
+
+TEST(hub_merges_rates_due_together) {
+  Rig rig;
+  rig.hub.set_update_interval(5000);
+  rig.leaving_water.set_update_interval(30000);
+  ASSERT_TRUE(rig.start());
+  uint32_t requests = rig.aurora.requests;
+  rig.run_cycle();  // The default rate on its own
+  uint32_t alone = rig.aurora.requests - requests;
+
+  // The 30s register shares the default rate's requests rather than adding its own
+  rig.hub.poll_all_rates();
+  requests = rig.aurora.requests;
+  rig.runner.run_until([&]() { return rig.aurora.requests != requests && rig.hub.idle(); }, 1000);
+  ASSERT_TRUE(alone > 0);
+  ASSERT_EQ(rig.aurora.requests - requests, alone);
+}
+
+TEST(hub_publishes_32bit_change_seen_by_faster_rate) {
+  Rig rig;
+  rig.hub.set_update_interval(10000);
+  // The lo word of total_power, also polled on its own every second
+  WaterFurnaceSensor lo_word;
+  lo_word.set_name("Power Lo Word");
+  lo_word.set_parent(&rig.hub);
+  lo_word.set_register_address(1153);
+  lo_word.set_update_interval(1000);
+  rig.runner.add(&lo_word);
+  ASSERT_TRUE(rig.start());
+  rig.runner.run_for(1000);
+  uint32_t published = rig.total_power.publish_count;
+
+  // The 1s rate reads the new lo word first; the 32-bit sensor still publishes it on its own cycle
+  rig.aurora.registers[1153] += 100;
+  float expected = rig.total_power.state + 100.0f;
+  ASSERT_TRUE(rig.runner.run_until([&]() { return lo_word.publish_count > 1; }, 2000));
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.total_power.publish_count > published; }, 12000));
+  ASSERT_FLOAT_EQ(rig.total_power.state, expected, 0.01f);
+}
+
+TEST(hub_scales_entity_rates_with_polling_mode) {
+  Rig rig;
+  rig.hub.set_update_interval(10000);
+  rig.hub.set_adaptive_polling(60000, 10000, 2000, 180000);
+  rig.leaving_water.set_update_interval(60000);
+  ASSERT_TRUE(rig.start());
+  rig.runner.run_for(1000);
+  ASSERT_TRUE(rig.hub.polling_mode() == PollingMode::RUNNING);
+
+  // Compressor off: a transition, in which the 60s sensor is read within 12s, not 60s
+  uint32_t published = rig.leaving_water.publish_count;
+  rig.aurora.registers[REG_SYSTEM_OUTPUTS] &= ~OUTPUT_CC;
+  rig.aurora.registers[1110] = 900;
+  rig.runner.run_until([&]() { return rig.hub.polling_mode() == PollingMode::TRANSITION; }, 15000);
+  ASSERT_TRUE(rig.hub.polling_mode() == PollingMode::TRANSITION);
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.leaving_water.publish_count > published; }, 13000));
+  ASSERT_FLOAT_EQ(rig.leaving_water.state, 90.0f, 0.01f);
+}
+
+TEST(hub_times_long_frame_from_before_write) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  // No TX ring buffer: a frame longer than the FIFO holds write_array() until the rest is in
+  rig.uart.tx_fifo_size = 128;
+  std::vector<uint16_t> addresses;
+  for (uint16_t i = 0; i < 70; i++)
+    addresses.push_back(1100 + i);  // 144-byte request
+  rig.hub.send_read(addresses);
+  uint32_t tx_end = rig.uart.tx_end_us;
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.idle(); }, 2000));
+  // DE released right after the last character, well before the reply starts
+  uint32_t char_us = rig.uart.char_time_us();
+  ASSERT_TRUE(rig.de.written_us - tx_end <= 2 * char_us + 1000);
+  // And the reply is taken as the answer, not as a late one to an earlier request
+  ASSERT_EQ(rig.hub.stale_responses(), 0u);
+  ASSERT_EQ(shim::log_count(ESPHOME_LOG_LEVEL_WARN), 0u);
+}
+
+// ====== Writes ======
+
+TEST(hub_switch_write_and_readback) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  uint32_t reads = rig.aurora.reads;
+  rig.dhw.turn_on();
+  ASSERT_TRUE(rig.dhw.state);  // Optimistic
+  ASSERT_TRUE(rig.runner.run_until([&]() { return !rig.aurora.writes.empty(); }, 1000));
+  ASSERT_EQ(rig.aurora.writes.back().first, REG_DHW_ENABLE);
+  ASSERT_EQ(rig.aurora.writes.back().second, 1);
+  // Read back straight after the write, well before the next update
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.aurora.reads > reads; }, 1000));
+  ASSERT_TRUE(rig.dhw.state);
+}
+
+TEST(hub_switch_corrected_without_readback) {
+  Rig rig;
+  rig.hub.set_update_interval(5000);
+  rig.aurora.mirrors[REG_DHW_ENABLE] = 0;  // The controller ignores the write
+  ASSERT_TRUE(rig.start());
+  rig.dhw.turn_off();
+  ASSERT_FALSE(rig.dhw.state);  // Optimistic
+  ASSERT_TRUE(rig.runner.run_until([&]() { return !rig.aurora.writes.empty(); }, 1000));
+  rig.aurora.drop = 2;  // The read-back and its retry
+
+  // The next regular poll puts the switch back, though register 400 never changed
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.backing_off(); }, 5000));
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.dhw.state; }, 10000));
+}
+
+TEST(hub_climate_setpoint_write) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  rig.thermostat.make_call().set_target_temperature_low(21.0f).perform();  // 69.8°F
+  ASSERT_TRUE(rig.runner.run_until([&]() { return !rig.aurora.writes.empty(); }, 1000));
+  ASSERT_EQ(rig.aurora.writes.back().first, REG_WRITE_HEATING_SP);
+  ASSERT_TRUE(rig.aurora.writes.back().second >= 697 && rig.aurora.writes.back().second <= 698);
+  // Confirmed from the register the thermostat reports it in
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.thermostat.target_temperature_low > 20.5f; }, 1000));
+}
+
+// ====== Failures ======
+
+TEST(hub_retries_then_backs_off) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  rig.aurora.drop = 2;  // The request and its retry
+  uint32_t requests = rig.aurora.requests;
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.backing_off(); }, 20000));
+  ASSERT_EQ(rig.aurora.requests, requests + 2);
+  ASSERT_EQ(shim::log_count(ESPHOME_LOG_LEVEL_WARN), 2u);  // Two timeouts
+
+  // Nothing goes out during the backoff, then polling resumes
+  rig.runner.run_for(500);
+  ASSERT_EQ(rig.aurora.requests, requests + 2);
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.idle(); }, 5000));
+  ASSERT_TRUE(rig.aurora.requests > requests + 2);
+}
+
+TEST(hub_retries_miscounted_setup_read) {
+  Rig rig;
+  // Idle framing takes the whole frame whatever its byte count says, and the CRC is good
+  rig.hub.set_framing(FramingMode::IDLE, 20000);
+  rig.aurora.miscount = 2;  // The setup read and its retry claim one value less than they carry
+  rig.runner.setup();
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.backing_off(); }, 5000));
+  ASSERT_FALSE(rig.hub.setup_complete());  // Nothing detected from a read that was not decoded
+
+  // The next attempt reads the whole setup block
+  ASSERT_TRUE(rig.runner.run_until([&]() { return rig.hub.setup_complete(); }, 10000));
+  ASSERT_TRUE(rig.hub.model_number() == "OTP509");
+  ASSERT_TRUE(rig.hub.has_vs_drive());
+  ASSERT_TRUE(rig.hub.has_energy_monitoring());
+}
+
+TEST(hub_write_ends_backoff) {
+  Rig rig;
+  float latency = -1.0f;
+  rig.hub.register_diagnostic_listener(Diagnostic::WRITE_LATENCY, [&latency](float v) { latency = v; });
+  ASSERT_TRUE(rig.start());
+  rig.aurora.drop = 8;  // Four requests and their retries: the last backoff is 8s
+  uint32_t requests = rig.aurora.requests;
+  ASSERT_TRUE(rig.runner.run_until(
+      [&]() { return rig.aurora.requests == requests + 8 && rig.hub.backing_off(); }, 60000));
+
+  // The write goes out at once rather than after the backoff
+  rig.dhw.turn_on();
+  ASSERT_TRUE(rig.runner.run_until([&]() { return !rig.aurora.writes.empty(); }, 500));
+  ASSERT_TRUE(latency >= 0.0f && latency < 100.0f);
+}
+
+TEST(hub_excludes_rejected_register) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  uint32_t published = rig.leaving_water.publish_count;
+  rig.aurora.rejected.insert(1152);  // Total power
+  rig.aurora.registers[1110] = 970;
+  ASSERT_TRUE(rig.runner.run_until([&]() { return !rig.hub.excluded_registers().empty(); }, 120000));
+  ASSERT_EQ(rig.hub.excluded_registers().size(), 1u);
+  ASSERT_EQ(rig.hub.excluded_registers()[0], 1152);
+  // The rest of the group is still read
+  rig.run_cycle();
+  ASSERT_TRUE(rig.leaving_water.publish_count > published);
+  ASSERT_FLOAT_EQ(rig.leaving_water.state, 97.0f, 0.01f);
+}
+
+TEST(hub_drops_stale_response) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  // A late answer to an earlier request lands right as the next one goes out
+  uint8_t late[MAX_FRAME_SIZE];
+  size_t len = build_read_ranges_request({{1110, 1}}, late, sizeof(late));
+  auto stale = rig.aurora.respond(late, len);
+  rig.aurora.requests--;
+  rig.aurora.reads--;
+  uint32_t requests = rig.aurora.requests;
+  rig.uart.responder = [&](const uint8_t *request, size_t request_len) {
+    if (rig.aurora.requests == requests)
+      rig.uart.inject(stale, shim::now_us());
+    return rig.aurora.respond(request, request_len);
+  };
+  rig.run_cycle();
+  ASSERT_EQ(rig.hub.excluded_registers().size(), 0u);
+  ASSERT_FALSE(rig.hub.backing_off());
+  ASSERT_TRUE(shim::log_count(ESPHOME_LOG_LEVEL_WARN) >= 1u);  // Discarded stale response
+}
+
+// ====== Cost ======
+
+TEST(hub_steady_cycle_allocates_nothing) {
+  Rig rig;
+  ASSERT_TRUE(rig.start());
+  rig.run_cycle();  // Every plan built and every string published once
+  rig.run_cycle();
+
+  alloc_count = 0;
+  alloc_tracking = true;
+  rig.run_cycle();
+  rig.run_cycle();
+  alloc_tracking = false;
+  ASSERT_EQ(alloc_count, 0u);
+}
+
+TEST(hub_multi_rate_cycles_allocate_nothing) {
+  Rig rig;
+  rig.hub.set_update_interval(5000);
+  rig.leaving_water.set_update_interval(7000);
+  rig.total_power.set_update_interval(11000);
+  ASSERT_TRUE(rig.start());
+  rig.runner.run_for(20000);  // Each rate polled on its own
+
+  // The rates drift in and out of phase: every mix of them is served from the plan
+  alloc_count = 0;
+  alloc_tracking = true;
+  rig.runner.run_for(70000);
+  alloc_tracking = false;
+  ASSERT_EQ(alloc_count, 0u);
+}
+
+// ====== Main ======
+
+int main() {
+  printf("WaterFurnace Hub Tests\n");
+  printf("======================\n\n");
+
+  printf("Setup:\n");
+  RUN(hub_detects_system);
+  RUN(hub_publishes_entities);
+  RUN(hub_publishes_identity_on_first_boot);
+  RUN(hub_boots_from_cached_setup);
+  RUN(hub_verify_publishes_new_identity);
+  RUN(hub_verify_detects_added_board);
+
+  printf("\nPolling:\n");
+  RUN(hub_publishes_only_changes);
+  RUN(hub_follows_update_interval);
+  RUN(hub_merges_rates_due_together);
+  RUN(hub_publishes_32bit_change_seen_by_faster_rate);
+  RUN(hub_scales_entity_rates_with_polling_mode);
+  RUN(hub_times_long_frame_from_before_write);
+
+  printf("\nWrites:\n");
+  RUN(hub_switch_write_and_readback);
+  RUN(hub_switch_corrected_without_readback);
+  RUN(hub_climate_setpoint_write);
+
+  printf("\nFailures:\n");
+  RUN(hub_retries_then_backs_off);
+  RUN(hub_retries_miscounted_setup_read);
+  RUN(hub_write_ends_backoff);
+  RUN(hub_excludes_rejected_register);
+  RUN(hub_drops_stale_response);
+
+  printf("\nCost:\n");
+  RUN(hub_steady_cycle_allocates_nothing);
+  RUN(hub_multi_rate_cycles_allocate_nothing);
+
+  printf("\n================================\n");
+  printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+  return tests_failed > 0 ? 1 : 0;
+}
@@ -1,13 +1,29 @@
-// Native unit tests for protocol.h/cpp and registers.h
-// Compile: g++ -std=c++17 -I../components/waterfurnace -o test_protocol test_protocol.cpp ../components/waterfurnace/protocol.cpp
+// Native unit tests for protocol.h/cpp, poll_planner.h/cpp, listener_table.h/cpp, register_cache.h/cpp,
+// frame_assembler.h/cpp, range_bisector.h/cpp, rtt_tracker.h/cpp, write_queue.h/cpp, bus_worker.h/cpp,
+// spsc_ring.h and registers.h
+// Compile: g++ -std=c++17 -I../components/waterfurnace -o test_protocol test_protocol.cpp ../components/waterfurnace/protocol.cpp ../components/waterfurnace/poll_planner.cpp ../components/waterfurnace/listener_table.cpp ../components/waterfurnace/register_cache.cpp ../components/waterfurnace/frame_assembler.cpp ../components/waterfurnace/range_bisector.cpp ../components/waterfurnace/rtt_tracker.cpp ../components/waterfurnace/write_queue.cpp ../components/waterfurnace/bus_worker.cpp -pthread
 // Run: ./test_protocol
 
+#include "bus_worker.h"
+#include "frame_assembler.h"
+#include "listener_table.h"
+#include "poll_planner.h"
 #include "protocol.h"
+#include "range_bisector.h"
+#include "register_cache.h"
 #include "registers.h"
+#include "rtt_tracker.h"
+#include "spsc_ring.h"
+#include "write_queue.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <new>
+#include <thread>
 #include <vector>
 
 using namespace esphome::waterfurnace;
@@ -38,6 +54,21 @@ static int tests_failed = 0;
     } \
   } while(0)
 
+// Heap allocations made while alloc_tracking is set
+static size_t alloc_count = 0;
+static bool alloc_tracking = false;
+
+void *operator new(size_t size) {
+  if (alloc_tracking)
+    alloc_count++;
+  void *ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
 #define ASSERT_TRUE(a) do { if (!(a)) { printf("FAIL: %s at line %d\n", #a, __LINE__); throw 1; } } while(0)
 #define ASSERT_FALSE(a) do { if (a) { printf("FAIL: !%s at line %d\n", #a, __LINE__); throw 1; } } while(0)
 
@@ -70,6 +101,62 @@ TEST(crc16_empty) {
   ASSERT_EQ(result, 0x10C0);
 }
 
+// The vectors above, as compile-time constants
+static constexpr uint8_t CRC_FUNC3[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01};
+static constexpr uint8_t CRC_FUNC65[] = {0x01, 0x41, 0x00, 0x58, 0x00, 0x04};
+static constexpr uint8_t CRC_FUNC66[] = {0x01, 0x42, 0x02, 0xE9, 0x02, 0xEA};
+static constexpr uint8_t CRC_HEADER[] = {0x01, 0x41};
+static_assert(crc16_constexpr(CRC_FUNC3, sizeof(CRC_FUNC3)) == 0x0A84, "constexpr CRC16");
+static_assert(crc16_constexpr(CRC_FUNC65, sizeof(CRC_FUNC65)) == 0xD5BD, "constexpr CRC16");
+static_assert(crc16_constexpr(CRC_FUNC66, sizeof(CRC_FUNC66)) == 0x6629, "constexpr CRC16");
+static_assert(crc16_constexpr(CRC_HEADER, sizeof(CRC_HEADER)) == 0x10C0, "constexpr CRC16");
+
+TEST(crc16_variants_known_vectors) {
+  struct Vector {
+    const uint8_t *data;
+    size_t len;
+    uint16_t crc;
+  };
+  const Vector vectors[] = {{CRC_FUNC3, sizeof(CRC_FUNC3), 0x0A84},
+                            {CRC_FUNC65, sizeof(CRC_FUNC65), 0xD5BD},
+                            {CRC_FUNC66, sizeof(CRC_FUNC66), 0x6629},
+                            {CRC_HEADER, sizeof(CRC_HEADER), 0x10C0}};
+  for (const auto &v : vectors) {
+    ASSERT_EQ(crc16_bitwise(v.data, v.len), v.crc);
+    ASSERT_EQ(crc16_table(v.data, v.len), v.crc);
+    ASSERT_EQ(crc16_slice4(v.data, v.len), v.crc);
+    ASSERT_EQ(crc16_constexpr(v.data, v.len), v.crc);
+  }
+}
+
+TEST(crc16_variants_match_bitwise) {
+  // Every length up to a full frame, so slice-by-4 hits every tail size
+  uint8_t data[MAX_FRAME_SIZE];
+  uint32_t seed = 12345;
+  for (auto &b : data) {
+    seed = seed * 1103515245 + 12345;
+    b = seed >> 16;
+  }
+  for (size_t len = 0; len <= sizeof(data); len++) {
+    uint16_t expected = crc16_bitwise(data, len);
+    ASSERT_EQ(crc16(data, len), expected);
+    ASSERT_EQ(crc16_table(data, len), expected);
+    ASSERT_EQ(crc16_slice4(data, len), expected);
+    ASSERT_EQ(crc16_constexpr(data, len), expected);
+  }
+}
+
+TEST(crc16_update_incremental) {
+  auto frame = build_read_ranges_request({{19, 2}, {30, 1}, {92, 12}});
+  uint16_t crc = CRC16_INIT;
+  for (uint8_t byte : frame)
+    crc = crc16_update(crc, &byte, 1);
+  // CRC over a frame including its own CRC is zero
+  ASSERT_EQ(crc, 0u);
+  ASSERT_EQ(crc16_update(crc16_update(CRC16_INIT, frame.data(), 5), frame.data() + 5, frame.size() - 7),
+            crc16(frame.data(), frame.size() - 2));
+}
+
 // ====== Frame Building Tests ======
 
 TEST(build_read_ranges_basic) {
@@ -145,6 +232,39 @@ TEST(build_write_single_request) {
   ASSERT_TRUE(validate_frame_crc(frame.data(), frame.size()));
 }
 
+TEST(build_into_buffer_matches_vector) {
+  uint8_t frame[MAX_FRAME_SIZE];
+  std::vector<std::pair<uint16_t, uint16_t>> ranges = {{19, 2}, {30, 1}, {92, 12}};
+  auto expected = build_read_ranges_request(ranges);
+  ASSERT_EQ(build_read_ranges_request(ranges, frame, sizeof(frame)), expected.size());
+  ASSERT_TRUE(memcmp(frame, expected.data(), expected.size()) == 0);
+
+  std::vector<uint16_t> addresses = {745, 746, 12005};
+  expected = build_read_registers_request(addresses);
+  ASSERT_EQ(build_read_registers_request(addresses, frame, sizeof(frame)), expected.size());
+  ASSERT_TRUE(memcmp(frame, expected.data(), expected.size()) == 0);
+
+  std::vector<std::pair<uint16_t, uint16_t>> writes = {{12619, 700}, {12620, 730}};
+  expected = build_write_registers_request(writes);
+  ASSERT_EQ(build_write_registers_request(writes, frame, sizeof(frame)), expected.size());
+  ASSERT_TRUE(memcmp(frame, expected.data(), expected.size()) == 0);
+
+  expected = build_write_single_request(400, 1);
+  ASSERT_EQ(build_write_single_request(400, 1, frame, sizeof(frame)), expected.size());
+  ASSERT_TRUE(memcmp(frame, expected.data(), expected.size()) == 0);
+}
+
+TEST(build_into_buffer_too_small) {
+  uint8_t frame[MAX_FRAME_SIZE];
+  ASSERT_EQ(build_write_single_request(400, 1, frame, 7), 0u);
+  ASSERT_EQ(build_write_single_request(400, 1, frame, 8), 8u);
+  // 64 ranges need 2 + 256 + 2 bytes
+  std::vector<std::pair<uint16_t, uint16_t>> ranges(64, {19, 1});
+  ASSERT_EQ(build_read_ranges_request(ranges, frame, sizeof(frame)), 0u);
+  ranges.pop_back();
+  ASSERT_EQ(build_read_ranges_request(ranges, frame, sizeof(frame)), 2 + 63 * 4 + 2u);
+}
+
 // ====== Frame Validation Tests ======
 
 TEST(validate_frame_crc_valid) {
@@ -163,6 +283,42 @@ TEST(validate_frame_crc_too_short) {
   ASSERT_FALSE(validate_frame_crc(data, 2));
 }
 
+TEST(transaction_matches_response) {
+  // Two-register func 65 read that finished transmitting at t=1000us, 573us per character
+  Transaction txn;
+  txn.func_code = FUNC_READ_RANGES;
+  txn.response_len = 9;
+  txn.sent_us = 1000;
+  uint8_t response[] = {0x01, FUNC_READ_RANGES, 0x04, 0x02, 0xBC, 0x02, 0xDA, 0x00, 0x00};
+  uint32_t arrived = 1000 + 9 * 573;
+  ASSERT_TRUE(answers_transaction(txn, response, 9, arrived, 573));
+  ASSERT_FALSE(answers_transaction(txn, response, 7, arrived, 573));  // Another group's length
+
+  uint8_t exception[] = {0x01, FUNC_READ_RANGES | ERROR_MASK, 0x02, 0x00, 0x00};
+  ASSERT_TRUE(answers_transaction(txn, exception, 5, arrived, 573));
+  exception[1] = FUNC_WRITE_REGISTERS | ERROR_MASK;
+  ASSERT_FALSE(answers_transaction(txn, exception, 5, arrived, 573));
+
+  uint8_t write_ack[] = {0x01, FUNC_WRITE_REGISTERS, 0x00, 0x00};
+  ASSERT_FALSE(answers_transaction(txn, write_ack, 4, arrived, 573));
+  response[0] = 0x02;
+  ASSERT_FALSE(answers_transaction(txn, response, 9, arrived, 573));
+}
+
+TEST(transaction_rejects_frame_already_in_flight) {
+  Transaction txn;
+  txn.func_code = FUNC_READ_REGISTERS;
+  txn.response_len = 9;
+  txn.sent_us = 0xFFFFFF00;  // Just before micros() wraps
+  uint8_t response[] = {0x01, FUNC_READ_REGISTERS, 0x04, 0x02, 0xBC, 0x02, 0xDA, 0x00, 0x00};
+  // Complete a few characters after the request: it was sent before the request ended
+  ASSERT_FALSE(answers_transaction(txn, response, 9, txn.sent_us + 3 * 573, 573));
+  // Received (drained) before the request was even sent
+  ASSERT_FALSE(answers_transaction(txn, response, 9, txn.sent_us - 100, 573));
+  // Enough time for the whole frame, across the wrap
+  ASSERT_TRUE(answers_transaction(txn, response, 9, txn.sent_us + 8 * 573, 573));
+}
+
 // ====== Response Parsing Tests ======
 
 TEST(parse_register_values_basic) {
@@ -187,6 +343,25 @@ TEST(parse_register_values_odd_bytes) {
   ASSERT_EQ(values[0], 700u);
 }
 
+TEST(parse_read_response_view) {
+  // slave, func 65, byte_count 4, 700, 730, CRC
+  uint8_t frame[] = {0x01, 0x41, 0x04, 0x02, 0xBC, 0x02, 0xDA, 0x00, 0x00};
+  auto values = parse_read_response(frame, sizeof(frame));
+  ASSERT_EQ(values.size(), 2u);
+  ASSERT_EQ(values[0], 700u);
+  ASSERT_EQ(values[1], 730u);
+  // Decoded in place: changing the frame changes the view
+  frame[4] = 0xBD;
+  ASSERT_EQ(values[0], 701u);
+}
+
+TEST(parse_read_response_truncated) {
+  // byte_count says 4 but only 2 data bytes + CRC arrived
+  uint8_t frame[] = {0x01, 0x41, 0x04, 0x02, 0xBC, 0x00, 0x00};
+  ASSERT_TRUE(parse_read_response(frame, sizeof(frame)).empty());
+  ASSERT_TRUE(parse_read_response(frame, 4).empty());
+}
+
 TEST(is_error_response_true) {
   ASSERT_TRUE(is_error_response(0xC1));   // 0x41 | 0x80
   ASSERT_TRUE(is_error_response(0xC2));   // 0x42 | 0x80
@@ -353,6 +528,18 @@ TEST(component_detect_ranges_count) {
   ASSERT_EQ(total, 22u);
 }
 
+TEST(setup_ranges_fit_one_request) {
+  // System ID and component detection are read in a single func 65 transaction
+  RegisterRanges ranges = get_system_id_ranges();
+  for (const auto &range : get_component_detect_ranges())
+    ranges.push_back(range);
+  auto normalized = normalize_ranges(ranges);
+  ASSERT_EQ(count_registers(normalized), 49u);
+  ASSERT_TRUE(count_registers(normalized) <= MAX_REGISTERS_PER_REQUEST);
+  ASSERT_EQ(plan_read_ranges(normalized).size(), 1u);
+  ASSERT_TRUE(build_read_ranges_request(normalized).size() <= MAX_FRAME_SIZE);
+}
+
 TEST(iz2_ranges_for_zones) {
   auto ranges = get_iz2_ranges(3);
   ASSERT_EQ(ranges.size(), 2u);
@@ -367,6 +554,1105 @@ TEST(iz2_ranges_zero_zones) {
   ASSERT_EQ(ranges.size(), 0u);
 }
 
+// ====== Poll Planner Tests ======
+
+static RegisterRanges all_subsystem_ranges(uint8_t zones) {
+  RegisterRanges ranges = get_thermostat_ranges();
+  for (const auto &more : {get_axb_ranges(), get_power_ranges(), get_vs_drive_ranges(), get_iz2_ranges(zones)})
+    ranges.insert(ranges.end(), more.begin(), more.end());
+  return ranges;
+}
+
+TEST(char_time_19200_8e1) {
+  // 11 bits at 19200 baud = 572.9us
+  ASSERT_EQ(char_time_us(BusTiming{}), 573u);
+}
+
+TEST(silent_interval_t35) {
+  // 3.5 x 11 bits at 19200 baud = 2005.2us
+  ASSERT_EQ(silent_interval_us(BusTiming{}), 2006u);
+  BusTiming slow{9600, 10};  // 8N1
+  ASSERT_EQ(silent_interval_us(slow), 3646u);
+  BusTiming fast{115200, 11};  // Fixed above 19200 baud
+  ASSERT_EQ(silent_interval_us(fast), 1750u);
+}
+
+TEST(normalize_merges_overlap_and_adjacent) {
+  auto ranges = normalize_ranges({{30, 2}, {19, 2}, {400, 2}, {21, 1}, {400, 1}, {31, 3}});
+  ASSERT_EQ(ranges.size(), 3u);
+  ASSERT_EQ(ranges[0].first, 19u);
+  ASSERT_EQ(ranges[0].second, 3u);
+  ASSERT_EQ(ranges[1].first, 30u);
+  ASSERT_EQ(ranges[1].second, 4u);
+  ASSERT_EQ(ranges[2].first, 400u);
+  ASSERT_EQ(ranges[2].second, 2u);
+}
+
+TEST(normalize_splits_at_breakpoint) {
+  auto ranges = normalize_ranges({{12098, 4}});
+  ASSERT_EQ(ranges.size(), 2u);
+  ASSERT_EQ(ranges[0].first, 12098u);
+  ASSERT_EQ(ranges[0].second, 2u);
+  ASSERT_EQ(ranges[1].first, 12100u);
+  ASSERT_EQ(ranges[1].second, 2u);
+}
+
+TEST(coalesce_bridges_single_register_gap) {
+  // 1 register gap (2 response bytes) is cheaper than a 4 byte range descriptor
+  auto ranges = coalesce_ranges({{25, 2}, {28, 2}});
+  ASSERT_EQ(ranges.size(), 1u);
+  ASSERT_EQ(ranges[0].first, 25u);
+  ASSERT_EQ(ranges[0].second, 5u);
+}
+
+TEST(coalesce_keeps_wider_gaps) {
+  // 2 register gap costs as much as a descriptor: keep two ranges
+  auto ranges = coalesce_ranges({{19, 2}, {23, 2}});
+  ASSERT_EQ(ranges.size(), 2u);
+}
+
+TEST(coalesce_never_bridges_breakpoint) {
+  auto ranges = coalesce_ranges({{12098, 2}, {12101, 1}});
+  ASSERT_EQ(ranges.size(), 2u);
+}
+
+TEST(coalesce_never_bridges_excluded) {
+  auto ranges = coalesce_ranges({{25, 2}, {28, 2}}, {27});
+  ASSERT_EQ(ranges.size(), 2u);
+  auto plan = plan_read_ranges({{25, 2}, {28, 2}}, BusTiming{}, {27});
+  ASSERT_EQ(plan.size(), 1u);
+  ASSERT_EQ(count_registers(plan[0]), 4u);
+}
+
+TEST(plan_merges_subsystems) {
+  // VS + AXB + IZ2 (6 zones): 110 registers fit in two func 65 requests
+  auto ranges = all_subsystem_ranges(6);
+  auto plan = plan_read_ranges(ranges);
+  ASSERT_EQ(plan.size(), 2u);
+  for (const auto &frame : plan) {
+    ASSERT_TRUE(count_registers(frame) <= MAX_REGISTERS_PER_REQUEST);
+    ASSERT_TRUE(build_read_ranges_request(frame).size() <= MAX_FRAME_SIZE);
+  }
+}
+
+TEST(plan_covers_every_register) {
+  auto ranges = all_subsystem_ranges(3);
+  auto plan = plan_read_ranges(ranges);
+  for (const auto &range : ranges) {
+    for (uint16_t i = 0; i < range.second; i++) {
+      uint16_t addr = range.first + i;
+      bool found = false;
+      for (const auto &frame : plan) {
+        for (const auto &r : frame) {
+          if (addr >= r.first && addr < r.first + r.second)
+            found = true;
+        }
+      }
+      ASSERT_TRUE(found);
+    }
+  }
+}
+
+TEST(plan_cuts_bus_time) {
+  // Baseline: one request per subsystem (5 transactions vs 2)
+  BusTiming timing;
+  uint32_t per_group = 0;
+  for (const auto &group : {get_thermostat_ranges(), get_axb_ranges(), get_power_ranges(),
+                            get_vs_drive_ranges(), get_iz2_ranges(6)})
+    per_group += estimate_read_ranges_us(group, timing);
+  uint32_t planned = estimate_plan_us(plan_read_ranges(all_subsystem_ranges(6), timing), timing);
+  ASSERT_TRUE(planned * 4 < per_group * 3);
+}
+
+TEST(plan_splits_oversize_range) {
+  auto plan = plan_read_ranges({{1000, 150}});
+  ASSERT_EQ(plan.size(), 2u);
+  ASSERT_EQ(count_registers(plan[0]) + count_registers(plan[1]), 150u);
+  ASSERT_EQ(count_registers(plan[0]), MAX_REGISTERS_PER_REQUEST);
+}
+
+// Index of the request that reads addr, or -1
+static int frame_of(const std::vector<RegisterRanges> &plan, uint16_t addr) {
+  for (size_t f = 0; f < plan.size(); f++) {
+    for (const auto &r : plan[f]) {
+      if (addr >= r.first && addr < r.first + r.second)
+        return static_cast<int>(f);
+    }
+  }
+  return -1;
+}
+
+TEST(plan_keeps_pair_across_register_limit) {
+  // A 32-bit value at 1099/1100 straddles the 100-register request boundary
+  auto plan = plan_read_ranges({{1000, 150}}, BusTiming{}, {}, {1099});
+  ASSERT_EQ(plan.size(), 2u);
+  ASSERT_EQ(count_registers(plan[0]) + count_registers(plan[1]), 150u);
+  ASSERT_TRUE(frame_of(plan, 1099) >= 0);
+  ASSERT_EQ(frame_of(plan, 1099), frame_of(plan, 1100));
+}
+
+TEST(plan_keeps_pair_when_filling_requests) {
+  // Three 60-register ranges fill two requests only if the middle one is split, at 1139/1140
+  RegisterRanges ranges = {{1000, 60}, {1100, 60}, {1200, 60}};
+  auto unpaired = plan_read_ranges(ranges);
+  ASSERT_EQ(unpaired.size(), 2u);
+  ASSERT_TRUE(frame_of(unpaired, 1139) != frame_of(unpaired, 1140));
+
+  auto plan = plan_read_ranges(ranges, BusTiming{}, {}, {1139});
+  ASSERT_EQ(plan.size(), 2u);
+  ASSERT_EQ(frame_of(plan, 1139), frame_of(plan, 1140));
+  for (const auto &frame : plan)
+    ASSERT_TRUE(count_registers(frame) <= MAX_REGISTERS_PER_REQUEST);
+}
+
+TEST(select_registers_filters_to_available) {
+  // Three sensors: compressor power (32-bit), EWT and a register no subsystem provides
+  auto selected = select_registers(all_subsystem_ranges(0), {1146, 1147, 1111, 92});
+  ASSERT_EQ(selected.size(), 2u);
+  ASSERT_EQ(selected[0].first, 1111u);
+  ASSERT_EQ(selected[0].second, 1u);
+  ASSERT_EQ(selected[1].first, 1146u);
+  ASSERT_EQ(selected[1].second, 2u);
+}
+
+TEST(select_registers_shrinks_vs_block) {
+  // Only discharge temp from the 9-register VS block at 3322
+  auto selected = select_registers(get_vs_drive_ranges(), {REG_VS_DISCHARGE_TEMP});
+  ASSERT_EQ(count_registers(selected), 1u);
+  auto plan = plan_read_ranges(selected);
+  ASSERT_EQ(plan.size(), 1u);
+  ASSERT_EQ(plan[0][0].first, REG_VS_DISCHARGE_TEMP);
+}
+
+TEST(plan_empty) {
+  auto plan = plan_read_ranges({});
+  ASSERT_EQ(plan.size(), 0u);
+}
+
+// Every page must build and its response fit a frame
+static bool pages_fit(const std::vector<ReadPage> &pages) {
+  uint8_t frame[MAX_FRAME_SIZE];
+  for (const auto &page : pages) {
+    if (page.addresses.empty() || page.addresses.size() > MAX_REGISTERS_PER_REQUEST)
+      return false;
+    if (read_response_size(page.addresses.size()) > MAX_FRAME_SIZE)
+      return false;
+    size_t len = page.func_code == FUNC_READ_RANGES ? build_read_ranges_request(page.ranges, frame, sizeof(frame))
+                                                     : build_read_registers_request(page.addresses, frame, sizeof(frame));
+    if (len == 0)
+      return false;
+  }
+  return true;
+}
+
+TEST(paginate_oversize_individual) {
+  std::vector<uint16_t> individual;
+  for (uint16_t i = 0; i < 250; i++)
+    individual.push_back(20000 + i * 3);
+  auto pages = paginate_read({}, individual);
+  ASSERT_EQ(pages.size(), 3u);
+  ASSERT_TRUE(pages_fit(pages));
+  size_t total = 0;
+  for (const auto &page : pages) {
+    ASSERT_EQ(page.func_code, FUNC_READ_REGISTERS);
+    total += page.addresses.size();
+  }
+  ASSERT_EQ(total, 250u);
+}
+
+TEST(paginate_mixed_keeps_everything) {
+  // A full range page plus individual registers: nothing is dropped any more
+  std::vector<uint16_t> individual = {12005, 12006, 1000};  // 1000 is already in the range
+  auto pages = paginate_read({{1000, 100}}, individual);
+  ASSERT_EQ(pages.size(), 2u);
+  ASSERT_TRUE(pages_fit(pages));
+  ASSERT_EQ(pages[0].func_code, FUNC_READ_RANGES);
+  ASSERT_EQ(pages[0].addresses.size(), 100u);
+  ASSERT_EQ(pages[1].func_code, FUNC_READ_REGISTERS);
+  ASSERT_EQ(pages[1].addresses.size(), 2u);
+  ASSERT_EQ(pages[1].addresses[0], 12005);
+}
+
+TEST(paginate_picks_smaller_function) {
+  // Scattered single registers: listing them (2 bytes each) beats describing ranges (4 bytes)
+  auto scattered = paginate_read({{100, 1}, {300, 1}, {500, 1}, {700, 1}});
+  ASSERT_EQ(scattered.size(), 1u);
+  ASSERT_EQ(scattered[0].func_code, FUNC_READ_REGISTERS);
+  ASSERT_EQ(scattered[0].addresses.size(), 4u);
+  // Runs of registers stay func 65
+  auto runs = paginate_read({{100, 10}, {300, 10}});
+  ASSERT_EQ(runs.size(), 1u);
+  ASSERT_EQ(runs[0].func_code, FUNC_READ_RANGES);
+  ASSERT_EQ(runs[0].addresses.size(), 20u);
+}
+
+TEST(paginate_merges_func66_pages) {
+  // The scattered page and the individual registers share one func 66 request
+  auto pages = paginate_read({{100, 1}, {300, 1}}, {12005, 12006});
+  ASSERT_EQ(pages.size(), 1u);
+  ASSERT_EQ(pages[0].func_code, FUNC_READ_REGISTERS);
+  ASSERT_EQ(pages[0].addresses.size(), 4u);
+  ASSERT_EQ(pages[0].addresses[0], 100);
+  ASSERT_EQ(pages[0].addresses[3], 12006);
+}
+
+// ====== Listener Table Tests ======
+
+static void add_listener(ListenerTable &table, uint16_t address, std::vector<int> &calls, int id) {
+  table.add({address, [&calls, id](uint16_t) { calls.push_back(id); }});
+}
+
+TEST(listener_table_groups_by_address) {
+  ListenerTable table;
+  std::vector<int> calls;
+  add_listener(table, 1147, calls, 0);
+  add_listener(table, 19, calls, 1);
+  add_listener(table, 1147, calls, 2);
+  add_listener(table, 30, calls, 3);
+  ASSERT_FALSE(table.is_frozen());
+  table.freeze();
+  ASSERT_TRUE(table.is_frozen());
+
+  auto span = table.find(1147);
+  ASSERT_EQ(span.end - span.begin, 2);
+  for (uint16_t i = span.begin; i < span.end; i++)
+    table[i].callback(0);
+  // Registration order is kept within an address
+  ASSERT_EQ(calls.size(), 2u);
+  ASSERT_EQ(calls[0], 0);
+  ASSERT_EQ(calls[1], 2);
+}
+
+TEST(listener_table_find_missing) {
+  ListenerTable table;
+  std::vector<int> calls;
+  add_listener(table, 19, calls, 0);
+  table.freeze();
+  ASSERT_TRUE(table.find(20).empty());
+  ASSERT_TRUE(table.find(0).empty());
+  ASSERT_TRUE(table.find(0xFFFF).empty());
+}
+
+TEST(listener_table_resolve_response_order) {
+  ListenerTable table;
+  std::vector<int> calls;
+  add_listener(table, 31, calls, 0);
+  add_listener(table, 19, calls, 1);
+  table.freeze();
+  auto spans = table.resolve({19, 20, 30, 31});
+  ASSERT_EQ(spans.size(), 4u);
+  ASSERT_EQ(table[spans[0].begin].address, 19u);
+  ASSERT_TRUE(spans[1].empty());
+  ASSERT_TRUE(spans[2].empty());
+  ASSERT_EQ(table[spans[3].begin].address, 31u);
+}
+
+TEST(listener_table_add_after_freeze) {
+  ListenerTable table;
+  std::vector<int> calls;
+  add_listener(table, 31, calls, 0);
+  table.freeze();
+  add_listener(table, 19, calls, 1);
+  ASSERT_FALSE(table.is_frozen());
+  table.freeze();
+  ASSERT_EQ(table.size(), 2u);
+  ASSERT_EQ(table[table.find(19).begin].address, 19u);
+  ASSERT_EQ(table[table.find(31).begin].address, 31u);
+}
+
+// ====== Register Cache Tests ======
+
+TEST(register_cache_assigns_sorted_slots) {
+  RegisterCache cache;
+  cache.assign({1147, 19, 1146, 19, 30});
+  ASSERT_EQ(cache.size(), 4u);
+  ASSERT_EQ(cache.find(19), 0);
+  ASSERT_EQ(cache.find(30), 1);
+  ASSERT_EQ(cache.find(1146), 2);
+  ASSERT_EQ(cache.find(1147), 3);
+  ASSERT_EQ(cache.find(20), RegisterCache::NO_SLOT);
+}
+
+TEST(register_cache_get_needs_value) {
+  RegisterCache cache;
+  cache.assign({19});
+  uint16_t value = 0;
+  ASSERT_FALSE(cache.get(19, value));
+  ASSERT_FALSE(cache.get(20, value));
+  cache.store(cache.find(19), 725);
+  ASSERT_TRUE(cache.get(19, value));
+  ASSERT_EQ(value, 725);
+}
+
+TEST(register_cache_tracks_changes) {
+  RegisterCache cache;
+  cache.assign({19});
+  uint16_t slot = cache.find(19);
+  cache.store(slot, 0);
+  ASSERT_TRUE(cache.changed(slot));  // First value always counts as a change
+  cache.clear_changed(slot);
+  cache.store(slot, 0);
+  ASSERT_FALSE(cache.changed(slot));
+  cache.store(slot, 1);
+  ASSERT_TRUE(cache.changed(slot));
+  // Stays a change until dispatched, even if the next read agrees
+  cache.store(slot, 1);
+  ASSERT_TRUE(cache.changed(slot));
+  cache.clear_changed(slot);
+  ASSERT_FALSE(cache.changed(slot));
+}
+
+TEST(register_cache_changed_spans_32bit) {
+  RegisterCache cache;
+  cache.assign({1146, 1147, 1149});
+  cache.store(cache.find(1146), 0);
+  cache.store(cache.find(1147), 500);
+  cache.store(cache.find(1149), 1);
+  cache.clear_changed(cache.find(1146));
+  cache.clear_changed(cache.find(1147));
+  cache.clear_changed(cache.find(1149));
+
+  cache.store(cache.find(1147), 501);  // Lo word only
+  ASSERT_FALSE(cache.changed(cache.find(1146)));
+  ASSERT_TRUE(cache.changed(cache.find(1146), 2));
+  cache.clear_changed(cache.find(1147));
+  // 1148 is not cached, so 1147's pair never reaches 1149
+  cache.store(cache.find(1149), 2);
+  ASSERT_FALSE(cache.changed(cache.find(1147), 2));
+}
+
+TEST(register_cache_words_packs_32bit) {
+  RegisterCache cache;
+  cache.assign({1146, 1147, 1149});
+  uint32_t value = 0;
+  ASSERT_FALSE(cache.words(cache.find(1146), 2, value));  // Nothing received yet
+  cache.store(cache.find(1146), 1);
+  ASSERT_FALSE(cache.words(cache.find(1146), 2, value));  // Lo word still missing
+  cache.store(cache.find(1147), 500);
+  ASSERT_TRUE(cache.words(cache.find(1146), 2, value));
+  ASSERT_EQ(value, 0x101F4u);
+  ASSERT_TRUE(cache.words(cache.find(1147), 1, value));
+  ASSERT_EQ(value, 500u);
+  // 1148 is not cached
+  cache.store(cache.find(1149), 2);
+  ASSERT_FALSE(cache.words(cache.find(1147), 2, value));
+}
+
+TEST(register_cache_reassign_keeps_values) {
+  RegisterCache cache;
+  cache.assign({19, 30});
+  cache.store(cache.find(30), 42);
+  cache.assign({30, 400});
+  uint16_t value = 0;
+  ASSERT_TRUE(cache.get(30, value));
+  ASSERT_EQ(value, 42);
+  ASSERT_FALSE(cache.contains(19));
+  ASSERT_FALSE(cache.get(400, value));
+}
+
+// ====== Allocation Tests ======
+
+// Answer a read request the way the ABC board would, with value = address + offset
+static size_t fake_read_response(const std::vector<uint16_t> &addresses, uint16_t offset, uint8_t *frame) {
+  size_t len = 0;
+  frame[len++] = SLAVE_ADDRESS;
+  frame[len++] = FUNC_READ_RANGES;
+  frame[len++] = static_cast<uint8_t>(addresses.size() * 2);
+  for (uint16_t addr : addresses) {
+    uint16_t value = addr + offset;
+    frame[len++] = value >> 8;
+    frame[len++] = value & 0xFF;
+  }
+  uint16_t crc = crc16(frame, len);
+  frame[len++] = crc & 0xFF;
+  frame[len++] = crc >> 8;
+  return len;
+}
+
+TEST(frame_apis_allocate_nothing) {
+  // Set up ahead (allowed to allocate): the ranges, cache slots and a response to feed back
+  std::vector<uint16_t> consumed = {19, 30, 31, 1111, 1146, 1147, 1153, 3322, 3325, 31007, 31010};
+  RegisterRanges ranges = select_registers(all_subsystem_ranges(6), consumed);
+  std::vector<uint16_t> addresses;
+  append_addresses(ranges, addresses);
+  std::vector<std::pair<uint16_t, uint16_t>> writes = {{340, 1}, {12619, 700}};
+  RegisterCache cache;
+  cache.assign(addresses);
+  std::vector<uint16_t> slots = cache.resolve(addresses);
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t response_len = fake_read_response(addresses, 0, response);
+  FrameAssembler rx;
+
+  uint8_t request[MAX_FRAME_SIZE];
+  uint8_t frame[MAX_FRAME_SIZE];
+  size_t built = 0, received = 0, changed = 0;
+  alloc_count = 0;
+  alloc_tracking = true;
+  for (int i = 0; i < 2; i++) {
+    built += build_read_ranges_request(ranges, request, sizeof(request)) > 0;
+    built += build_read_registers_request(consumed, request, sizeof(request)) > 0;
+    built += build_write_registers_request(writes, request, sizeof(request)) > 0;
+    built += build_write_single_request(340, 1, request, sizeof(request)) > 0;
+    // The response arrives in two chunks, as a UART driver hands it over
+    rx.write(response, response_len / 2);
+    rx.write(response + response_len / 2, response_len - response_len / 2);
+    size_t len = rx.poll(frame);
+    RegisterValues values = parse_read_response(frame, len);
+    received += values.size();
+    for (size_t v = 0; v < values.size(); v++)
+      cache.store(slots[v], values[v]);
+    for (uint16_t slot : slots) {
+      changed += cache.changed(slot);
+      cache.clear_changed(slot);
+    }
+  }
+  alloc_tracking = false;
+
+  ASSERT_EQ(alloc_count, 0u);
+  ASSERT_EQ(built, 8u);
+  ASSERT_EQ(received, 2 * addresses.size());
+  ASSERT_EQ(changed, addresses.size());  // Only the first response changes anything
+}
+
+TEST(vector_builders_fit_the_frame) {
+  // Stored for the life of the plan, so no spare capacity
+  auto request = build_read_registers_request({19, 30, 31});
+  ASSERT_EQ(request.size(), 10u);
+  ASSERT_EQ(request.capacity(), 10u);
+  // Frames larger than MAX_FRAME_SIZE are still built; splitting is the planner's job
+  std::vector<uint16_t> many(150);
+  for (size_t i = 0; i < many.size(); i++)
+    many[i] = 1000 + i;
+  request = build_read_registers_request(many);
+  ASSERT_EQ(request.size(), 2 + 2 * many.size() + 2);
+  ASSERT_TRUE(validate_frame_crc(request.data(), request.size()));
+}
+
+// ====== Frame Assembler Tests ======
+
+// A 100-register func 65 response (205 bytes), the largest we poll
+static size_t full_read_response(uint8_t *frame, uint16_t offset = 0) {
+  std::vector<uint16_t> addresses;
+  for (uint16_t i = 0; i < MAX_REGISTERS_PER_REQUEST; i++)
+    addresses.push_back(1100 + i);
+  return fake_read_response(addresses, offset, frame);
+}
+
+TEST(assembler_trickle_byte_by_byte) {
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t len = full_read_response(response);
+  ASSERT_EQ(len, 205u);
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  for (size_t i = 0; i + 1 < len; i++) {
+    ASSERT_EQ(rx.write(response + i, 1), 1u);
+    ASSERT_EQ(rx.poll(frame), 0u);
+  }
+  ASSERT_EQ(rx.write(response + len - 1, 1), 1u);
+  ASSERT_EQ(rx.poll(frame), len);
+  ASSERT_TRUE(memcmp(frame, response, len) == 0);
+  ASSERT_EQ(rx.buffered(), 0u);
+}
+
+TEST(assembler_back_to_back_frames) {
+  uint8_t bytes[MAX_FRAME_SIZE];
+  auto first = build_write_single_request(400, 1);  // Same layout as the func 6 echo
+  size_t len = fake_read_response({19, 20}, 0, bytes + first.size());
+  memcpy(bytes, first.data(), first.size());
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, first.size() + len);
+  ASSERT_EQ(rx.poll(frame), 8u);
+  ASSERT_EQ(frame[1], FUNC_WRITE_SINGLE);
+  ASSERT_EQ(rx.poll(frame), len);
+  ASSERT_EQ(frame[1], FUNC_READ_RANGES);
+  ASSERT_EQ(rx.poll(frame), 0u);
+}
+
+TEST(assembler_wraps_ring) {
+  // Bulk reads straight into the ring, many times around it
+  FrameAssembler rx;
+  uint8_t response[MAX_FRAME_SIZE];
+  uint8_t frame[MAX_FRAME_SIZE];
+  for (uint16_t n = 0; n < 10; n++) {
+    size_t len = full_read_response(response, n);
+    size_t written = 0;
+    while (written < len) {
+      size_t contiguous;
+      uint8_t *dst = rx.write_ptr(contiguous);
+      size_t chunk = std::min<size_t>(std::min<size_t>(contiguous, 64), len - written);
+      memcpy(dst, response + written, chunk);
+      rx.commit(chunk);
+      written += chunk;
+      ASSERT_EQ(rx.poll(frame), written == len ? len : 0u);
+    }
+    ASSERT_EQ(parse_read_response(frame, len)[0], 1100u + n);
+  }
+}
+
+TEST(assembler_drops_bad_crc) {
+  uint8_t bytes[2 * MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 0, bytes);
+  memcpy(bytes + len, bytes, len);
+  bytes[4] ^= 0x01;  // Corrupt a data byte of the first copy
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, 2 * len);
+  ASSERT_EQ(rx.poll(frame), len);
+  ASSERT_EQ(rx.crc_errors(), 1u);
+  ASSERT_EQ(parse_read_response(frame, len)[0], 19u);
+}
+
+TEST(assembler_error_response) {
+  uint8_t bytes[] = {SLAVE_ADDRESS, FUNC_READ_RANGES | ERROR_MASK, 0x02, 0x00, 0x00};
+  uint16_t crc = crc16(bytes, 3);
+  bytes[3] = crc & 0xFF;
+  bytes[4] = crc >> 8;
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, 4);
+  ASSERT_EQ(rx.poll(frame), 0u);
+  rx.write(bytes + 4, 1);
+  ASSERT_EQ(rx.poll(frame), 5u);
+  ASSERT_TRUE(is_error_response(frame[1]));
+}
+
+TEST(assembler_reset_drops_partial) {
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t len = full_read_response(response);
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(response, 100);
+  ASSERT_EQ(rx.poll(frame), 0u);
+  rx.reset();
+  rx.write(response, len);
+  ASSERT_EQ(rx.poll(frame), len);
+}
+
+TEST(assembler_skips_leading_noise) {
+  // Line noise ahead of the response, including a byte equal to the slave address
+  uint8_t bytes[MAX_FRAME_SIZE] = {0x00, 0xFF, SLAVE_ADDRESS, 0x7F};
+  size_t len = fake_read_response({19, 20}, 0, bytes + 4);
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, 4 + len);
+  ASSERT_EQ(rx.poll(frame), len);
+  ASSERT_EQ(parse_read_response(frame, len)[0], 19u);
+  ASSERT_EQ(rx.skipped_bytes(), 4u);
+  ASSERT_EQ(rx.crc_errors(), 0u);
+}
+
+TEST(assembler_resyncs_inside_bad_candidate) {
+  // A truncated response followed by the real one: the bogus candidate's length swallows
+  // the start of the real frame, which must still be found in the same poll
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t len = full_read_response(response);
+  uint8_t bytes[2 * MAX_FRAME_SIZE];
+  memcpy(bytes, response, 20);
+  memcpy(bytes + 20, response, len);
+
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, 20 + len);
+  ASSERT_EQ(rx.poll(frame), len);
+  ASSERT_TRUE(memcmp(frame, response, len) == 0);
+  ASSERT_EQ(rx.crc_errors(), 1u);
+  ASSERT_EQ(rx.skipped_bytes(), 20u);
+  ASSERT_EQ(rx.buffered(), 0u);
+}
+
+TEST(assembler_plausible_header) {
+  uint8_t ok[] = {SLAVE_ADDRESS, FUNC_READ_RANGES, 4};
+  uint8_t wrong_slave[] = {0x02, FUNC_READ_RANGES, 4};
+  uint8_t wrong_func[] = {SLAVE_ADDRESS, 0x03, 4};
+  uint8_t odd_count[] = {SLAVE_ADDRESS, FUNC_READ_REGISTERS, 5};
+  uint8_t huge_count[] = {SLAVE_ADDRESS, FUNC_READ_RANGES, 250};
+  uint8_t error[] = {SLAVE_ADDRESS, FUNC_WRITE_REGISTERS | ERROR_MASK, 3};
+  ASSERT_TRUE(FrameAssembler::plausible_header(ok, 3));
+  ASSERT_TRUE(FrameAssembler::plausible_header(ok, 1));
+  ASSERT_TRUE(!FrameAssembler::plausible_header(wrong_slave, 1));
+  ASSERT_TRUE(!FrameAssembler::plausible_header(wrong_func, 2));
+  ASSERT_TRUE(!FrameAssembler::plausible_header(odd_count, 3));
+  ASSERT_TRUE(!FrameAssembler::plausible_header(huge_count, 3));
+  ASSERT_TRUE(FrameAssembler::plausible_header(error, 3));
+}
+
+TEST(assembler_idle_framing_closes_on_silence) {
+  uint8_t bytes[MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 0, bytes);
+
+  FrameAssembler rx;
+  rx.set_framing(FramingMode::IDLE);
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, len);
+  ASSERT_EQ(rx.poll(frame), 0u);  // Never by length
+  ASSERT_EQ(rx.close(frame), len);
+  ASSERT_EQ(parse_read_response(frame, len)[1], 20u);
+  ASSERT_EQ(rx.idle_frames(), 1u);
+  ASSERT_EQ(rx.length_frames(), 0u);
+}
+
+TEST(assembler_idle_close_drops_malformed) {
+  // Byte count corrupted upwards: length framing would wait for bytes that never come
+  uint8_t bytes[MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 0, bytes);
+  bytes[2] = 100;
+
+  FrameAssembler rx;
+  rx.set_framing(FramingMode::AUTO);
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, len);
+  ASSERT_EQ(rx.poll(frame), 0u);
+  ASSERT_EQ(rx.close(frame), 0u);
+  ASSERT_EQ(rx.malformed_frames(), 1u);
+  ASSERT_EQ(rx.buffered(), 0u);
+
+  // The next good response still frames by length
+  len = fake_read_response({19, 20}, 0, bytes);
+  rx.write(bytes, len);
+  ASSERT_EQ(rx.poll(frame), len);
+  ASSERT_EQ(rx.length_frames(), 1u);
+  ASSERT_EQ(rx.close(frame), 0u);  // Nothing left
+}
+
+TEST(assembler_length_framing_ignores_close) {
+  uint8_t bytes[MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 0, bytes);
+  FrameAssembler rx;
+  uint8_t frame[MAX_FRAME_SIZE];
+  rx.write(bytes, len - 1);
+  ASSERT_EQ(rx.close(frame), 0u);
+  ASSERT_EQ(rx.malformed_frames(), 0u);
+  rx.write(bytes + len - 1, 1);
+  ASSERT_EQ(rx.poll(frame), len);
+}
+
+// ====== Response Timing Tests ======
+
+TEST(rtt_percentiles) {
+  RttTracker rtt;
+  ASSERT_EQ(rtt.percentile(50), 0u);
+  for (uint32_t i = 1; i <= 20; i++)
+    rtt.add(i * 1000);
+  ASSERT_EQ(rtt.count(), 20u);
+  ASSERT_EQ(rtt.percentile(50), 10000u);
+  ASSERT_EQ(rtt.percentile(95), 19000u);
+  ASSERT_EQ(rtt.percentile(100), 20000u);
+  ASSERT_EQ(rtt.percentile(0), 1000u);
+}
+
+TEST(rtt_window_slides) {
+  RttTracker rtt;
+  for (size_t i = 0; i < RttTracker::WINDOW; i++)
+    rtt.add(500000);  // An early slow spell...
+  for (size_t i = 0; i < RttTracker::WINDOW; i++)
+    rtt.add(20000);  // ...ages out completely
+  ASSERT_EQ(rtt.count(), RttTracker::WINDOW);
+  ASSERT_EQ(rtt.percentile(100), 20000u);
+}
+
+TEST(rtt_limit) {
+  RttTracker rtt;
+  for (size_t i = 0; i + 1 < RttTracker::MIN_SAMPLES; i++)
+    rtt.add(20000);
+  ASSERT_EQ(rtt.limit_us(100000, 2000000), 2000000u);  // Not enough samples yet
+  rtt.add(20000);
+  ASSERT_EQ(rtt.limit_us(100000, 2000000), 3 * 20000u + RttTracker::SLACK_US);
+  ASSERT_EQ(rtt.limit_us(200000, 2000000), 200000u);  // Floor
+  for (size_t i = 0; i < RttTracker::WINDOW; i++)
+    rtt.add(1000000);
+  ASSERT_EQ(rtt.limit_us(100000, 2000000), 2000000u);  // Ceiling
+}
+
+TEST(backoff_doubles_to_cap) {
+  ASSERT_EQ(backoff_delay(1, 1000, 60000), 1000u);
+  ASSERT_EQ(backoff_delay(2, 1000, 60000), 2000u);
+  ASSERT_EQ(backoff_delay(4, 1000, 60000), 8000u);
+  ASSERT_EQ(backoff_delay(7, 1000, 60000), 60000u);
+  ASSERT_EQ(backoff_delay(255, 1000, 60000), 60000u);
+}
+
+// ====== Range Bisector Tests ======
+
+// Run a bisection against a controller that rejects any read touching one of bad
+static size_t run_bisection(RangeBisector &bisector, const std::vector<uint16_t> &bad) {
+  size_t probes = 0;
+  while (bisector.active() && probes < 100) {
+    bool accepted = true;
+    for (const auto &range : bisector.probe()) {
+      for (uint16_t addr : bad) {
+        if (addr >= range.first && addr < range.first + range.second)
+          accepted = false;
+      }
+    }
+    bisector.report(accepted);
+    probes++;
+  }
+  return probes;
+}
+
+TEST(bisector_finds_single_register) {
+  std::vector<uint16_t> addresses;
+  for (uint16_t i = 0; i < 64; i++)
+    addresses.push_back(3000 + i);
+  RangeBisector bisector;
+  bisector.start(addresses);
+  size_t probes = run_bisection(bisector, {3037});
+  ASSERT_EQ(bisector.found().size(), 1u);
+  ASSERT_EQ(bisector.found()[0], 3037u);
+  ASSERT_EQ(probes, 12u);  // Both halves at each of 6 levels
+  ASSERT_EQ(bisector.probes(), probes);
+}
+
+TEST(bisector_finds_several_registers) {
+  RangeBisector bisector;
+  bisector.start({19, 20, 30, 31, 32, 344, 400, 401});
+  run_bisection(bisector, {31, 401});
+  auto found = bisector.found();
+  std::sort(found.begin(), found.end());
+  ASSERT_EQ(found.size(), 2u);
+  ASSERT_EQ(found[0], 31u);
+  ASSERT_EQ(found[1], 401u);
+}
+
+TEST(bisector_probes_are_ranges) {
+  RangeBisector bisector;
+  bisector.start({10, 11, 12, 13, 20, 21, 22, 23});
+  auto probe = bisector.probe();
+  ASSERT_EQ(probe.size(), 1u);
+  ASSERT_EQ(probe[0].first, 10u);
+  ASSERT_EQ(probe[0].second, 4u);
+}
+
+TEST(bisector_transient_rejection_finds_nothing) {
+  RangeBisector bisector;
+  bisector.start({19, 20, 21, 22});
+  run_bisection(bisector, {});
+  ASSERT_TRUE(!bisector.active());
+  ASSERT_TRUE(bisector.found().empty());
+  ASSERT_EQ(bisector.probes(), 2u);
+}
+
+// ====== Write Queue Tests ======
+
+TEST(write_queue_last_writer_wins) {
+  WriteQueue queue;
+  ASSERT_TRUE(!queue.set(REG_WRITE_HEATING_SP, 680, 100));
+  ASSERT_TRUE(queue.set(REG_WRITE_HEATING_SP, 690, 200));
+  ASSERT_TRUE(queue.set(REG_WRITE_HEATING_SP, 700, 300));
+  ASSERT_EQ(queue.size(), 1u);
+  ASSERT_EQ(queue.coalesced(), 2u);
+  ASSERT_EQ(queue.oldest(), 100u);
+  auto batch = queue.take();
+  ASSERT_EQ(batch.size(), 1u);
+  ASSERT_EQ(batch[0].second, 700);
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(write_queue_modes_before_setpoints) {
+  WriteQueue queue;
+  queue.set(REG_WRITE_HEATING_SP, 680, 0);
+  queue.set(REG_WRITE_COOLING_SP, 750, 0);
+  queue.set(REG_WRITE_MODE, MODE_AUTO, 0);
+  queue.set(REG_WRITE_FAN_MODE, FAN_CONTINUOUS, 0);
+  auto batch = queue.take();
+  ASSERT_EQ(batch.size(), 4u);
+  ASSERT_EQ(batch[0].first, REG_WRITE_MODE);
+  ASSERT_EQ(batch[1].first, REG_WRITE_FAN_MODE);
+  ASSERT_EQ(batch[2].first, REG_WRITE_HEATING_SP);
+  ASSERT_EQ(batch[3].first, REG_WRITE_COOLING_SP);
+}
+
+TEST(write_queue_rank_iz2_zones) {
+  // Zone 3: mode at +0 and fan mode at +3, setpoints at +1 and +2
+  uint16_t zone3 = REG_IZ2_WRITE_BASE + 2 * 9;
+  ASSERT_EQ(WriteQueue::write_rank(zone3), 0);
+  ASSERT_EQ(WriteQueue::write_rank(zone3 + 1), 1);
+  ASSERT_EQ(WriteQueue::write_rank(zone3 + 2), 1);
+  ASSERT_EQ(WriteQueue::write_rank(zone3 + 3), 0);
+  ASSERT_EQ(WriteQueue::write_rank(REG_DHW_ENABLE), 0);
+  ASSERT_EQ(WriteQueue::write_rank(REG_DHW_SETPOINT), 1);
+}
+
+TEST(write_queue_splits_frames) {
+  WriteQueue queue;
+  for (uint16_t i = 0; i < MAX_WRITES_PER_REQUEST + 10; i++)
+    queue.set(1000 + i, i, i);
+  auto first = queue.take();
+  ASSERT_EQ(first.size(), MAX_WRITES_PER_REQUEST);
+  uint8_t frame[MAX_FRAME_SIZE];
+  ASSERT_TRUE(build_write_registers_request(first, frame, sizeof(frame)) > 0);
+  ASSERT_EQ(queue.size(), 10u);
+  ASSERT_EQ(queue.oldest(), static_cast<uint32_t>(MAX_WRITES_PER_REQUEST));
+  auto second = queue.take();
+  ASSERT_EQ(second.front().first, 1000 + MAX_WRITES_PER_REQUEST);
+  ASSERT_TRUE(queue.empty());
+}
+
+// ====== Bus Worker Tests ======
+
+TEST(spsc_ring_fifo_and_full) {
+  SpscRing<int, 4> ring;
+  int item;
+  ASSERT_FALSE(ring.pop(item));
+  for (int round = 0; round < 3; round++) {  // Positions run past the capacity
+    for (int i = 0; i < 4; i++)
+      ASSERT_TRUE(ring.push(round * 10 + i));
+    ASSERT_FALSE(ring.push(99));
+    ASSERT_EQ(ring.size(), 4u);
+    for (int i = 0; i < 4; i++) {
+      ASSERT_TRUE(ring.pop(item));
+      ASSERT_EQ(item, round * 10 + i);
+    }
+    ASSERT_TRUE(ring.empty());
+  }
+}
+
+TEST(spsc_ring_two_threads) {
+  static constexpr uint32_t COUNT = 200000;
+  SpscRing<uint32_t, 8> ring;
+  std::thread producer([&ring]() {
+    for (uint32_t i = 0; i < COUNT; i++) {
+      while (!ring.push(i))
+        std::this_thread::yield();
+    }
+  });
+  uint32_t expected = 0;
+  bool in_order = true;
+  while (expected < COUNT) {
+    uint32_t item;
+    if (!ring.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_order &= item == expected;
+    expected++;
+  }
+  producer.join();
+  ASSERT_TRUE(in_order);
+  ASSERT_TRUE(ring.empty());
+}
+
+// Serial line on a virtual clock: the test schedules what arrives and when
+class FakeBusPort : public BusPort {
+ public:
+  void write(const uint8_t *data, size_t len) override { this->tx.insert(this->tx.end(), data, data + len); }
+  size_t read(uint8_t *data, size_t max) override {
+    this->now += this->read_stall;  // The worker preempted between taking the time and reading
+    if (this->rx.empty() || static_cast<int32_t>(this->now - this->rx_at) < 0)
+      return 0;
+    size_t n = std::min(max, this->rx.size());
+    memcpy(data, this->rx.data(), n);
+    this->rx.erase(this->rx.begin(), this->rx.begin() + n);
+    return n;
+  }
+  void set_transmit(bool transmit) override { this->transmitting = transmit; }
+  uint32_t micros() override { return this->now; }
+  void yield() override {}
+
+  void arrive(const uint8_t *data, size_t len, uint32_t at) {
+    this->rx.assign(data, data + len);
+    this->rx_at = at;
+  }
+
+  uint32_t now{1000};
+  uint32_t read_stall{0};
+  bool transmitting{false};
+  std::vector<uint8_t> tx;
+  std::vector<uint8_t> rx;
+  uint32_t rx_at{0};
+};
+
+static BusRequest bus_read_request(uint32_t id, uint32_t timeout_us) {
+  BusRequest request;
+  request.id = id;
+  request.len = static_cast<uint16_t>(build_read_ranges_request({{19, 2}}, request.frame, sizeof(request.frame)));
+  request.response_len = static_cast<uint16_t>(read_response_size(2));
+  request.timeout_us = timeout_us;
+  return request;
+}
+
+// Step the worker on the virtual clock until a result comes out or limit_us passes
+static bool step_until_result(BusWorker &worker, FakeBusPort &port, BusResult &result, uint32_t limit_us) {
+  uint32_t end = port.now + limit_us;
+  while (static_cast<int32_t>(port.now - end) < 0) {
+    worker.step();
+    if (worker.poll(result))
+      return true;
+    port.now += 100;
+  }
+  return false;
+}
+
+TEST(bus_worker_exchange) {
+  FakeBusPort port;
+  BusTiming timing;
+  BusWorker worker(&port, timing);
+  ASSERT_TRUE(worker.submit(bus_read_request(7, 100000)));
+
+  ASSERT_TRUE(worker.step());
+  ASSERT_TRUE(port.transmitting);
+  ASSERT_EQ(port.tx.size(), read_ranges_request_size(1));
+  ASSERT_FALSE(worker.step());  // Still on the wire
+  port.now += (port.tx.size() + 1) * char_time_us(timing);
+  ASSERT_TRUE(worker.step());
+  ASSERT_FALSE(port.transmitting);
+
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 0, response);
+  port.arrive(response, len, port.now + timing.turnaround_us + len * char_time_us(timing));
+  BusResult result;
+  ASSERT_TRUE(step_until_result(worker, port, result, 100000));
+  ASSERT_EQ(result.id, 7u);
+  ASSERT_TRUE(result.status == BusStatus::RESPONSE);
+  ASSERT_EQ(result.len, len);
+  ASSERT_TRUE(memcmp(result.frame, response, len) == 0);
+  ASSERT_TRUE(result.received_us - result.sent_us >= timing.turnaround_us);
+  ASSERT_EQ(result.length_frames, 1u);
+}
+
+TEST(bus_worker_stamps_bytes_when_read) {
+  FakeBusPort port;
+  BusTiming timing;
+  BusWorker worker(&port, timing);
+  worker.submit(bus_read_request(3, 1000000));
+  worker.step();
+  port.now += (port.tx.size() + 1) * char_time_us(timing);
+  worker.step();
+
+  // The response completes while the worker is preempted: it still answers the request
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 0, response);
+  uint32_t complete = port.now + len * char_time_us(timing);
+  port.arrive(response, len, complete);
+  port.now = complete - 1000;
+  port.read_stall = 2000;
+  worker.step();
+  BusResult result;
+  ASSERT_TRUE(worker.poll(result));
+  ASSERT_TRUE(result.status == BusStatus::RESPONSE);
+  ASSERT_TRUE(static_cast<int32_t>(result.received_us - complete) >= 0);
+  ASSERT_EQ(result.stale_responses, 0u);
+}
+
+TEST(bus_worker_timeout) {
+  FakeBusPort port;
+  BusWorker worker(&port, BusTiming{});
+  worker.submit(bus_read_request(1, 50000));
+  BusResult result;
+  ASSERT_TRUE(step_until_result(worker, port, result, 100000));
+  ASSERT_EQ(result.id, 1u);
+  ASSERT_TRUE(result.status == BusStatus::TIMEOUT);
+  ASSERT_TRUE(result.received_us - result.sent_us > 50000u);
+}
+
+TEST(bus_worker_drops_stale_response) {
+  FakeBusPort port;
+  BusTiming timing;
+  BusWorker worker(&port, timing);
+  worker.submit(bus_read_request(2, 200000));
+  worker.step();
+  port.now += (port.tx.size() + 1) * char_time_us(timing);
+  worker.step();
+
+  // Complete as soon as the request is out: it was already on the wire, so it answers an earlier request
+  uint8_t response[MAX_FRAME_SIZE];
+  size_t len = fake_read_response({19, 20}, 1, response);
+  port.arrive(response, len, port.now);
+  worker.step();
+  BusResult result;
+  ASSERT_FALSE(worker.poll(result));
+
+  len = fake_read_response({19, 20}, 2, response);
+  port.arrive(response, len, port.now + len * char_time_us(timing));
+  ASSERT_TRUE(step_until_result(worker, port, result, 100000));
+  ASSERT_TRUE(result.status == BusStatus::RESPONSE);
+  ASSERT_EQ(result.frame[4], 19 + 2);
+  ASSERT_EQ(result.stale_responses, 1u);
+}
+
+TEST(bus_worker_malformed_on_idle) {
+  FakeBusPort port;
+  BusTiming timing;
+  BusWorker worker(&port, timing);
+  worker.set_framing(FramingMode::IDLE, silent_interval_us(timing));
+  worker.submit(bus_read_request(3, 500000));
+  worker.step();
+  port.now += (port.tx.size() + 1) * char_time_us(timing);
+  worker.step();
+
+  uint8_t garbage[] = {SLAVE_ADDRESS, FUNC_READ_RANGES, 0x04, 0x00, 0x13, 0xFF};
+  port.arrive(garbage, sizeof(garbage), port.now + 10000);
+  BusResult result;
+  ASSERT_TRUE(step_until_result(worker, port, result, 100000));
+  ASSERT_TRUE(result.status == BusStatus::MALFORMED);
+}
+
+// Real clock, for the threaded worker: answers each request a little after it is out
+class LoopbackBusPort : public BusPort {
+ public:
+  explicit LoopbackBusPort(const BusTiming &timing) : char_us_(char_time_us(timing)) {}
+  void write(const uint8_t * /*data*/, size_t len) override {
+    this->reply_len_ = fake_read_response({19, 20}, this->served_++, this->reply_);
+    this->reply_at_ = this->micros() + (len + 1 + this->reply_len_) * this->char_us_ + 200;
+  }
+  size_t read(uint8_t *data, size_t max) override {
+    if (this->reply_len_ == 0 || static_cast<int32_t>(this->micros() - this->reply_at_) < 0)
+      return 0;
+    size_t n = std::min(max, this->reply_len_);
+    memcpy(data, this->reply_, n);
+    this->reply_len_ = 0;
+    return n;
+  }
+  uint32_t micros() override {
+    auto since = std::chrono::steady_clock::now() - this->start_;
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(since).count());
+  }
+  void yield() override { std::this_thread::yield(); }
+
+ protected:
+  std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+  uint32_t char_us_;
+  uint16_t served_{0};
+  uint8_t reply_[MAX_FRAME_SIZE];
+  size_t reply_len_{0};
+  uint32_t reply_at_{0};
+};
+
+TEST(bus_worker_thread_delivers_in_order) {
+  static constexpr uint32_t COUNT = 50;
+  BusTiming timing;
+  timing.baud_rate = 1000000;  // Keep the exchanges short
+  LoopbackBusPort port(timing);
+  BusWorker worker(&port, timing);
+  ASSERT_TRUE(worker.start());
+
+  uint32_t submitted = 0, received = 0;
+  bool in_order = true;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (received < COUNT && std::chrono::steady_clock::now() < deadline) {
+    if (submitted < COUNT && worker.submit(bus_read_request(submitted + 1, 1000000)))
+      submitted++;
+    BusResult result;
+    if (!worker.poll(result)) {
+      std::this_thread::yield();
+      continue;
+    }
+    received++;
+    in_order &= result.id == received && result.status == BusStatus::RESPONSE &&
+                result.frame[4] == 19 + received - 1;
+  }
+  worker.stop();
+  ASSERT_FALSE(worker.running());
+  ASSERT_EQ(received, COUNT);
+  ASSERT_TRUE(in_order);
+}
+
 // ====== Main ======
 
 int main() {
@@ -378,6 +1664,9 @@ int main() {
   RUN(crc16_func65_request);
   RUN(crc16_func66_request);
   RUN(crc16_empty);
+  RUN(crc16_variants_known_vectors);
+  RUN(crc16_variants_match_bitwise);
+  RUN(crc16_update_incremental);
 
   printf("\nFrame Building:\n");
   RUN(build_read_ranges_basic);
@@ -385,16 +1674,22 @@ int main() {
   RUN(build_read_registers_request);
   RUN(build_write_registers_request);
   RUN(build_write_single_request);
+  RUN(build_into_buffer_matches_vector);
+  RUN(build_into_buffer_too_small);
 
   printf("\nFrame Validation:\n");
   RUN(validate_frame_crc_valid);
   RUN(validate_frame_crc_invalid);
   RUN(validate_frame_crc_too_short);
+  RUN(transaction_matches_response);
+  RUN(transaction_rejects_frame_already_in_flight);
 
   printf("\nResponse Parsing:\n");
   RUN(parse_register_values_basic);
   RUN(parse_register_values_empty);
   RUN(parse_register_values_odd_bytes);
+  RUN(parse_read_response_view);
+  RUN(parse_read_response_truncated);
   RUN(is_error_response_true);
   RUN(is_error_response_false);
 
@@ -426,9 +1721,93 @@ int main() {
   printf("\nRegister Groups:\n");
   RUN(system_id_ranges_count);
   RUN(component_detect_ranges_count);
+  RUN(setup_ranges_fit_one_request);
   RUN(iz2_ranges_for_zones);
   RUN(iz2_ranges_zero_zones);
 
+  printf("\nPoll Planner:\n");
+  RUN(char_time_19200_8e1);
+  RUN(silent_interval_t35);
+  RUN(normalize_merges_overlap_and_adjacent);
+  RUN(normalize_splits_at_breakpoint);
+  RUN(coalesce_bridges_single_register_gap);
+  RUN(coalesce_keeps_wider_gaps);
+  RUN(coalesce_never_bridges_breakpoint);
+  RUN(coalesce_never_bridges_excluded);
+  RUN(plan_merges_subsystems);
+  RUN(plan_covers_every_register);
+  RUN(plan_cuts_bus_time);
+  RUN(plan_splits_oversize_range);
+  RUN(plan_keeps_pair_across_register_limit);
+  RUN(plan_keeps_pair_when_filling_requests);
+  RUN(select_registers_filters_to_available);
+  RUN(select_registers_shrinks_vs_block);
+  RUN(plan_empty);
+  RUN(paginate_oversize_individual);
+  RUN(paginate_mixed_keeps_everything);
+  RUN(paginate_picks_smaller_function);
+  RUN(paginate_merges_func66_pages);
+
+  printf("\nListener Table:\n");
+  RUN(listener_table_groups_by_address);
+  RUN(listener_table_find_missing);
+  RUN(listener_table_resolve_response_order);
+  RUN(listener_table_add_after_freeze);
+
+  printf("\nRegister Cache:\n");
+  RUN(register_cache_assigns_sorted_slots);
+  RUN(register_cache_get_needs_value);
+  RUN(register_cache_tracks_changes);
+  RUN(register_cache_changed_spans_32bit);
+  RUN(register_cache_words_packs_32bit);
+  RUN(register_cache_reassign_keeps_values);
+
+  printf("\nAllocations:\n");
+  RUN(frame_apis_allocate_nothing);
+  RUN(vector_builders_fit_the_frame);
+
+  printf("\nFrame Assembler:\n");
+  RUN(assembler_trickle_byte_by_byte);
+  RUN(assembler_back_to_back_frames);
+  RUN(assembler_wraps_ring);
+  RUN(assembler_drops_bad_crc);
+  RUN(assembler_error_response);
+  RUN(assembler_reset_drops_partial);
+  RUN(assembler_skips_leading_noise);
+  RUN(assembler_resyncs_inside_bad_candidate);
+  RUN(assembler_plausible_header);
+  RUN(assembler_idle_framing_closes_on_silence);
+  RUN(assembler_idle_close_drops_malformed);
+  RUN(assembler_length_framing_ignores_close);
+
+  printf("\nRange Bisector:\n");
+  RUN(bisector_finds_single_register);
+  RUN(bisector_finds_several_registers);
+  RUN(bisector_probes_are_ranges);
+  RUN(bisector_transient_rejection_finds_nothing);
+
+  printf("\nResponse Timing:\n");
+  RUN(rtt_percentiles);
+  RUN(rtt_window_slides);
+  RUN(rtt_limit);
+  RUN(backoff_doubles_to_cap);
+
+  printf("\nWrite Queue:\n");
+  RUN(write_queue_last_writer_wins);
+  RUN(write_queue_modes_before_setpoints);
+  RUN(write_queue_rank_iz2_zones);
+  RUN(write_queue_splits_frames);
+
+  printf("\nBus Worker:\n");
+  RUN(spsc_ring_fifo_and_full);
+  RUN(spsc_ring_two_threads);
+  RUN(bus_worker_exchange);
+  RUN(bus_worker_stamps_bytes_when_read);
+  RUN(bus_worker_timeout);
+  RUN(bus_worker_drops_stale_response);
+  RUN(bus_worker_malformed_on_idle);
+  RUN(bus_worker_thread_delivers_in_order);
+
   printf("\n================================\n");
   printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
   return tests_failed > 0 ? 1 : 0;